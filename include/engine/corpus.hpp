@@ -0,0 +1,41 @@
+#pragma once
+#ifndef PLANKTON_ENGINE_CORPUS_HPP
+#define PLANKTON_ENGINE_CORPUS_HPP
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <istream>
+#include <optional>
+
+namespace plankton {
+
+    /**
+     * A recorded SMT query: the premise of an 'Encoding' together with the checks discharged against it.
+     * Both are stored as SMT-LIB, check 'i' is asserted as '(= __chk__i <check>)'.
+     */
+    struct CorpusEntry {
+        enum Kind { CHECK, IMPLIES, UNSAT };
+
+        Kind kind;
+        std::string category;
+        std::chrono::microseconds time;
+        std::vector<bool> results; // one per check, for UNSAT whether the premise is unsatisfiable
+        std::string premise;
+        std::string checks;
+    };
+
+    struct CorpusReplay {
+        std::vector<bool> results;
+        std::chrono::microseconds time; // solving only, excludes parsing the entry
+    };
+
+    std::string ToString(CorpusEntry::Kind kind);
+
+    std::optional<CorpusEntry> ReadCorpusEntry(std::istream& stream); // std::nullopt if the stream is exhausted
+
+    CorpusReplay ReplayCorpusEntry(const CorpusEntry& entry); // uses the setup passed to 'SetupEncoding'
+
+} // namespace plankton
+
+#endif //PLANKTON_ENGINE_CORPUS_HPP
@@ -3,6 +3,10 @@
 #define PLANKTON_ENGINE_ENCODING_HPP
 
 #include <map>
+#include <future>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <variant>
 #include "logics/ast.hpp"
 #include "solver.hpp"
@@ -11,22 +15,8 @@
 
 namespace plankton {
     
-    struct InternalExpr {
-        virtual ~InternalExpr() = default;
-        [[nodiscard]] virtual std::unique_ptr<InternalExpr> Negate() const = 0;
-        [[nodiscard]] virtual std::unique_ptr<InternalExpr> And(const InternalExpr& other) const = 0;
-        [[nodiscard]] virtual std::unique_ptr<InternalExpr> Or(const InternalExpr& other) const = 0;
-        [[nodiscard]] virtual std::unique_ptr<InternalExpr> Eq(const InternalExpr& other) const = 0;
-        [[nodiscard]] virtual std::unique_ptr<InternalExpr> Neq(const InternalExpr& other) const = 0;
-        [[nodiscard]] virtual std::unique_ptr<InternalExpr> Lt(const InternalExpr& other) const = 0;
-        [[nodiscard]] virtual std::unique_ptr<InternalExpr> Leq(const InternalExpr& other) const = 0;
-        [[nodiscard]] virtual std::unique_ptr<InternalExpr> Gt(const InternalExpr& other) const = 0;
-        [[nodiscard]] virtual std::unique_ptr<InternalExpr> Geq(const InternalExpr& other) const = 0;
-        [[nodiscard]] virtual std::unique_ptr<InternalExpr> Implies(const InternalExpr& other) const = 0;
-        [[nodiscard]] virtual std::unique_ptr<InternalExpr> Contains(const InternalExpr& other) const = 0;
-        [[nodiscard]] virtual std::unique_ptr<InternalExpr> Copy() const = 0;
-    };
-    
+    struct InternalExprAccess;
+
     struct InternalStorage {
         virtual ~InternalStorage() = default;
     };
@@ -44,20 +34,61 @@ namespace plankton {
         EExpr operator>>(const EExpr& other) const;
         EExpr operator()(const EExpr& other) const;
     
-        [[nodiscard]] const InternalExpr& Repr() const;
-        explicit EExpr(std::unique_ptr<InternalExpr> repr);
         EExpr(const EExpr& other);
+        EExpr(EExpr&& other) noexcept;
         EExpr& operator=(const EExpr& other);
-    
+        EExpr& operator=(EExpr&& other) noexcept;
+        ~EExpr();
+
         private:
-            std::unique_ptr<InternalExpr> repr;
+            /**
+             * The solver's handle for the expression is stored inline rather than behind a pointer, so that building,
+             * copying, and destroying expressions does not allocate. Only the solver backend interprets the storage,
+             * see 'InternalExprAccess' in the engine's 'internal.hpp'.
+             */
+            enum struct Kind : unsigned char { EXPR, FUNC_DECL };
+            static constexpr std::size_t STORAGE_SIZE = 2 * sizeof(void*);
+
+            alignas(void*) unsigned char storage[STORAGE_SIZE];
+            Kind kind;
+
+            explicit EExpr(Kind kind); // leaves 'storage' uninitialized
+            friend struct InternalExprAccess;
     };
     
+    void SetupEncoding(std::shared_ptr<const EngineSetup> setup); // applies to all encodings created afterwards
+
+    struct SolvingStatistics {
+        std::size_t undecided = 0; // queries Z3 returned 'unknown' for, e.g., due to exceeding their budget
+        std::size_t decidedByRetry = 0; // ... decided when retried with an escalated budget
+        std::size_t decidedByPortfolio = 0; // ... decided by the solver portfolio
+        std::size_t assumedNotImplied = 0; // ... given up and treated as not implied, in batch checks only
+        std::size_t failed = 0; // ... given up and reported as an error
+    };
+
+    SolvingStatistics GetSolvingStatistics();
+
+    struct CheckHandle final { // batch of checks solved in the background, see 'Encoding::CheckAsync'
+        CheckHandle() = default;
+        CheckHandle(CheckHandle&& other) noexcept = default;
+        CheckHandle& operator=(CheckHandle&& other) noexcept = default;
+
+        [[nodiscard]] bool IsReady() const;
+        void Join(); // blocks until solved, then invokes the callbacks on the calling thread; no-op if joined
+
+        private:
+            std::future<std::vector<bool>> result;
+            std::deque<std::function<void(bool)>> callbacks;
+            friend struct Encoding;
+    };
+
     struct Encoding { // TODO: rename to 'StackEncoding' ?
         explicit Encoding();
         explicit Encoding(const Formula& premise);
         explicit Encoding(const Formula& premise, const SolverConfig& config);
         explicit Encoding(const FlowGraph& graph);
+        Encoding(Encoding&& other) noexcept = default;
+        ~Encoding();
         
         void AddPremise(const EExpr& expr);
         void AddPremise(const Formula& premise);
@@ -66,9 +97,11 @@ namespace plankton {
         void AddPremise(const FlowGraph& graph);
         void Push();
         void Pop();
+        void SetCategory(std::string category); // tags queries, see 'EngineSetup::smtRecordPath' and 'smtParamsByCategory'
         
         void AddCheck(const EExpr& expr, std::function<void(bool)> callback);
         void Check();
+        [[nodiscard]] CheckHandle CheckAsync(); // like 'Check', but callbacks are deferred until the handle is joined
         
         bool ImpliesFalse();
         bool Implies(const EExpr& expr);
@@ -126,17 +159,24 @@ namespace plankton {
         EExpr Replace(const EExpr& expression, const EExpr& replace, const EExpr& with);
         EExpr EncodeForAll(const std::vector<EExpr>& quantified, const EExpr& inner);
         explicit Encoding(const std::string& smtLib);
+        std::deque<EExpr> ParseChecks(const std::string& smtLib); // see 'CorpusEntry'
 
         private:
             std::unique_ptr<InternalStorage> internal;
             std::deque<EExpr> checks_premise;
             std::deque<std::function<void(bool)>> checks_callback;
+            std::string category;
             std::map<const VariableDeclaration*, EExpr> variableEncoding;
             std::map<const SymbolDeclaration*, EExpr> symbolEncoding;
+            std::unordered_multimap<std::size_t, std::pair<std::unique_ptr<LogicObject>, EExpr>> formulaEncoding; // keyed by 'SyntacticalHash'
+            std::unordered_map<const LogicObject*, const std::pair<std::unique_ptr<LogicObject>, EExpr>*> formulaEncodingByAddress; // entry of 'formulaEncoding' last matched by the object at an address
+            std::unordered_set<std::size_t> formulaHashes; // 'SyntacticalHash' of formulas encoded so far, only repeated ones are memoized
             
             EExpr MakeQuantifiedVariable(Sort sort);
             EExpr EncodeFlowRules(const FlowGraphNode& node);
             EExpr EncodeOutflow(const FlowGraphNode& node, const PointerField& field, EMode mode);
+            EExpr EncodeInvariant(const MemoryAxiom& memory, const SolverConfig& config);
+            EExpr EncodeInvariant(const EqualsToAxiom& variable, const SolverConfig& config);
     };
     
 } // plankton
@@ -0,0 +1,29 @@
+#pragma once
+#ifndef PLANKTON_ENGINE_PARAMS_HPP
+#define PLANKTON_ENGINE_PARAMS_HPP
+
+#include <map>
+#include <string>
+#include <istream>
+#include <ostream>
+#include "setup.hpp"
+
+namespace plankton {
+
+    /**
+     * Z3 parameters per query category, see 'EngineSetup::smtParamsByCategory' and 'Encoding::SetCategory'.
+     * Parameter files list one parameter per line as 'category name value', lines starting with '#' are comments.
+     * The parameters of category '*' apply to all categories, the ones of a specific category take precedence.
+     */
+    static constexpr const char* SMT_PARAMS_ALL_CATEGORIES = "*";
+
+    using SmtParamsByCategory = std::map<std::string, SmtParams>;
+
+    SmtParamsByCategory ReadSmtParams(std::istream& stream); // checks the parameters, see 'CheckSmtParams'
+    void WriteSmtParams(std::ostream& stream, const SmtParamsByCategory& params);
+
+    void CheckSmtParams(const SmtParams& params); // throws if Z3 does not know a parameter or rejects its value
+
+} // namespace plankton
+
+#endif //PLANKTON_ENGINE_PARAMS_HPP
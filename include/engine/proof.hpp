@@ -4,6 +4,8 @@
 
 #include <deque>
 #include <memory>
+#include <sstream>
+#include <unordered_map>
 #include "programs/ast.hpp"
 #include "logics/ast.hpp"
 #include "engine/config.hpp"
@@ -40,22 +42,43 @@ namespace plankton {
 
     private:
         using AnnotationList = std::deque<std::unique_ptr<Annotation>>;
-        using PrePostPair = std::pair<std::unique_ptr<Annotation>, AnnotationList>;
+        using Footprint = std::set<const Type*>; // node types of the shared memory on which interference was consulted
+        static constexpr const Type* ANY_TYPE = nullptr; // in a 'Footprint': interference was consulted regardless of type
+        struct TabulatedPost {
+            std::unique_ptr<Annotation> pre;
+            AnnotationList post;
+            Footprint footprint; // the post remains valid as long as no new effect updates memory of these types
+        };
+        struct MacroPostTable {
+            std::deque<TabulatedPost> entries;
+            std::unordered_multimap<std::size_t, std::size_t> index; // 'SyntacticalHash' of 'pre' ~> entry
+        };
+
+        struct Shared; // state shared with the generators of concurrently verified functions, see 'MakeWorker'
 
         const Program& program;
-        Solver solver;
+        std::shared_ptr<Shared> shared;
+        Solver& solver;
         std::shared_ptr<EngineSetup> setup;
         std::deque<std::unique_ptr<HeapEffect>> newInterference;
         std::deque<std::unique_ptr<Annotation>> current;
         std::deque<std::unique_ptr<Annotation>> breaking;
         std::deque<std::pair<std::unique_ptr<Annotation>, const Return*>> returning;
-        std::map<const Function*, std::deque<PrePostPair>> macroPostTable;
+        std::map<const Function*, MacroPostTable> macroPostTable; // persists across iterations, see 'InvalidateMacroPosts'
+        Footprint footprint; // of the function currently verified
+        std::map<const Function*, Footprint> functionFootprints; // of API functions, as of their latest verification
+        std::optional<Footprint> newInterferenceTypes; // node types updated by the latest new effects, none ~> all
         bool insideAtomic;
-        std::deque<std::unique_ptr<FutureSuggestion>> futureSuggestions;
+        std::size_t transformerThreads; // disjuncts of 'current' transformed concurrently, on threads shared with the other functions
+        const std::deque<std::unique_ptr<FutureSuggestion>>& futureSuggestions;
+        std::stringstream footprintBuffer; // export of a worker, appended by the parent, see 'FootprintRedirect'
 
         #define INFO_SIZE (" (" + std::to_string(current.size()) + ") ")
         StatusStack infoPrefix;
-        Timer timePost, timeJoin, timeInterference, timePastImprove, timePastReduce, timeFutureImprove, timeFutureReduce;
+        Timer &timePost, &timeJoin, &timeInterference, &timePastImprove, &timePastReduce, &timeFutureImprove, &timeFutureReduce;
+
+        explicit ProofGenerator(const ProofGenerator& parent); // shares the parent's 'Shared' state, see 'MakeWorker'
+        [[nodiscard]] std::unique_ptr<ProofGenerator> MakeWorker() const;
     
         void HandleInterfaceFunction(const Function& function);
         void HandleMacroLazy(const Macro& macro);
@@ -63,8 +86,14 @@ namespace plankton {
         void HandleMacroProlog(const Macro& macro);
         void HandleMacroEpilog(const Macro& macro);
         std::optional<AnnotationList> LookupMacroPost(const Macro& node, const Annotation& pre);
-        void AddMacroPost(const Macro& node, const Annotation& pre, const AnnotationList& post);
+        void AddMacroPost(const Function& macro, const Annotation& pre, const AnnotationList& post, const Footprint& footprint);
+        void AdoptMacroPosts(const ProofGenerator& worker);
+        void InvalidateMacroPosts();
 
+        void RecordFootprint(bool improvesPast);
+        void RecordFootprint(const Annotation& annotation, bool improvesPast);
+        [[nodiscard]] bool IsAffectedByNewInterference(const Footprint& footprint) const;
+        [[nodiscard]] bool IsAffectedByNewInterference(const Function& function) const;
         void MakeInterferenceStable(const Statement& after);
         void AddNewInterference(std::deque<std::unique_ptr<HeapEffect>> effects);
         bool ConsolidateNewInterference();
@@ -75,6 +104,7 @@ namespace plankton {
         void ImproveCurrentTime();
         void ReduceCurrentTime();
         void LeaveAllNestedScopes(const AstNode& node);
+        void AppendFootprints(const std::stringstream& buffer);
         void ApplyTransformer(const std::function<std::unique_ptr<Annotation>(std::unique_ptr<Annotation>)>& transformer);
         void ApplyTransformer(const std::function<PostImage(std::unique_ptr<Annotation>)>& transformer);
     };
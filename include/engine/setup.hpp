@@ -2,10 +2,16 @@
 #ifndef PLANKTON_ENGINE_SETUP_HPP
 #define PLANKTON_ENGINE_SETUP_HPP
 
+#include <map>
+#include <string>
 #include <fstream>
 
 namespace plankton {
 
+    enum struct SmtMethod { ADAPTIVE, PUSH_POP, ASSUMPTIONS, BACKBONE };
+    enum struct SmtBackend { Z3, CVC5 }; // CVC5 requires building with cvc5, falls back to Z3 otherwise
+    using SmtParams = std::map<std::string, std::string>; // Z3 parameter names to values, e.g., 'mbqi' to 'false'
+
     struct EngineSetup {
         // TODO: configurable join
         // TODO: configurable extension policies in various places
@@ -20,6 +26,31 @@ namespace plankton {
 
         // proof
         std::size_t proofMaxIterations = 7;
+        // both levels are caps on the 'ThreadPool', which they share: together, they use at most the hardware concurrency
+        std::size_t proofThreadCount = 0; // API functions verified concurrently per iteration, 0 ~> hardware concurrency
+        std::size_t proofTransformerThreadCount = 0; // disjuncts transformed concurrently per function, 0 ~> hardware concurrency
+
+        // smt solving
+        SmtMethod smtMethod = SmtMethod::ADAPTIVE; // ADAPTIVE ~> 'solver::consequences', falls back to BACKBONE
+        std::size_t smtWorkerCount = 0; // 0 ~> twice the hardware concurrency
+        std::size_t smtBatchSize = 16;
+        bool smtFilterByModel = true; // drop checks falsified by models of the premise before solving them
+        std::size_t smtFilterMaxRounds = 8;
+        bool smtPortfolio = true; // race several solver configurations on queries Z3 returned 'unknown' for
+        unsigned int smtTimeout = 0; // milliseconds per query, 0 ~> unlimited
+        unsigned int smtResourceLimit = 0; // Z3 'rlimit' per query, 0 ~> unlimited
+        unsigned int smtBudgetEscalation = 8; // budget factor for retrying queries that exceeded their budget
+        bool smtGroundQuantifiers = false; // instantiate flow quantifiers over the query's data terms, incomplete
+        bool smtFiniteDomain = false; // encode data as bitvectors and flows as arrays rather than integers and functions, implies 'smtGroundQuantifiers'
+        bool smtUninterpretedSorts = false; // encode pointers and thread ids as uninterpreted sorts rather than integers
+        SmtBackend smtBackend = SmtBackend::Z3;
+        std::map<std::string, SmtBackend> smtBackendByCategory; // overrides 'smtBackend', see 'Encoding::SetCategory'
+        std::map<std::string, SmtParams> smtParamsByCategory; // Z3 parameters per query category, see 'engine/params.hpp'
+        bool smtPresolve = true; // decide implications among stack axioms natively before invoking Z3
+        bool smtPreprocess = false; // eliminate aliases and simplify the premise once per batch of checks
+        std::string smtPreprocessTactics = "simplify,propagate-values"; // must preserve equivalence, e.g., no 'solve-eqs'
+        bool smtAsync = true; // 'Encoding::CheckAsync' solves in a background thread rather than right away
+        std::string smtRecordPath; // appends queries to this file if non-empty, see 'CorpusEntry'
 
         // output files
         std::ofstream footprints;
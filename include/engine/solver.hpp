@@ -77,6 +77,24 @@ namespace plankton {
     
     std::ostream& operator<<(std::ostream& out, const HeapEffect& object);
 
+
+    /**
+     * While alive, the footprint export of the calling thread goes to 'buffer' rather than to 'EngineSetup::footprints'.
+     * Functions and disjuncts that are verified concurrently export to buffers of their own, their caller appends
+     * them in order, so that the export is not interleaved.
+     */
+    struct FootprintRedirect final {
+        explicit FootprintRedirect(std::ostream& buffer);
+        ~FootprintRedirect();
+        FootprintRedirect(const FootprintRedirect& other) = delete;
+        FootprintRedirect& operator=(const FootprintRedirect& other) = delete;
+
+        private:
+            std::ostream* previous;
+    };
+
+    std::ostream& GetFootprintStream(EngineSetup& setup); // 'FootprintRedirect' of the calling thread, if any
+
 } // namespace plankton
 
 #endif //PLANKTON_ENGINE_SOLVER_HPP
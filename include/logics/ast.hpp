@@ -3,6 +3,7 @@
 #define PLANKTON_LOGICS_AST_HPP
 
 #include <set>
+#include <map>
 #include <deque>
 #include <memory>
 #include <functional>
@@ -34,6 +35,7 @@ namespace plankton {
         std::string name;
         const Type& type;
         Order order;
+        std::size_t id; // dense, unique among all symbols
         
         SymbolDeclaration(const SymbolDeclaration&) = delete;
         
@@ -41,7 +43,7 @@ namespace plankton {
         [[nodiscard]] bool operator!=(const SymbolDeclaration& other) const;
         
         private:
-            explicit SymbolDeclaration(std::string name, const Type& type, Order order);
+            explicit SymbolDeclaration(std::string name, const Type& type, Order order, std::size_t id);
             friend struct SymbolFactory;
     };
     
@@ -59,6 +61,7 @@ namespace plankton {
         
         private:
             std::set<const SymbolDeclaration*> inUse;
+            std::map<std::pair<const Type*, Order>, std::size_t> next; // symbols of a kind before 'next' are in use
     };
 
     //
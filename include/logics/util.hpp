@@ -25,6 +25,7 @@ namespace plankton {
                                 const std::function<bool(const T&)>& filter = [](auto&) { return true; });
 
     bool SyntacticalEqual(const LogicObject& object, const LogicObject& other);
+    std::size_t SyntacticalHash(const LogicObject& object); // consistent with 'SyntacticalEqual'
     std::unique_ptr<Annotation> Normalize(std::unique_ptr<Annotation> annotation);
 
     void Simplify(LogicObject& object);
@@ -4,6 +4,7 @@
 
 #include <array>
 #include <vector>
+#include <sstream>
 #include <iostream>
 
 namespace plankton {
@@ -19,7 +20,8 @@ namespace plankton {
         #define DEBUG_FOREACH(X, F) {}
     #endif
     
-    #define INFO(X) { std::cout << X; }
+    // formatted first and written at once, so that lines of concurrent proof workers do not interleave
+    #define INFO(X) { std::stringstream infoStream; infoStream << X; std::cout << infoStream.str() << std::flush; }
 
     #define WARNING(X) { std::cerr << "WARNING: " << X; }
     
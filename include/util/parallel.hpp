@@ -0,0 +1,129 @@
+#pragma once
+#ifndef PLANKTON_UTIL_PARALLEL_HPP
+#define PLANKTON_UTIL_PARALLEL_HPP
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+namespace plankton {
+
+    inline std::size_t GetConcurrency(std::size_t requested) { // 0 ~> hardware concurrency
+        if (requested > 0) return requested;
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    /**
+     * Process-wide threads, one per hardware thread, running the helpers of 'ParallelFor'. All levels of nested
+     * parallelism share them, e.g., the API functions verified concurrently and the disjuncts those transform, so
+     * that together they never exceed the hardware concurrency. Idle threads help whichever level has work left.
+     */
+    struct ThreadPool final {
+        static ThreadPool& Get() {
+            // never destroyed: threads block on 'wakeup' until the process exits
+            static auto* pool = new ThreadPool(GetConcurrency(0));
+            return *pool;
+        }
+
+        ThreadPool(const ThreadPool& other) = delete;
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+
+        [[nodiscard]] std::size_t GetThreadCount() const {
+            return threads.size();
+        }
+
+        void Submit(std::function<void()> task) { // 'task' must not throw
+            {
+                std::lock_guard guard(mutex);
+                tasks.push_back(std::move(task));
+            }
+            wakeup.notify_one();
+        }
+
+        private:
+            std::mutex mutex;
+            std::condition_variable wakeup;
+            std::deque<std::function<void()>> tasks;
+            std::vector<std::thread> threads;
+
+            explicit ThreadPool(std::size_t threadCount) {
+                threads.reserve(threadCount);
+                for (std::size_t index = 0; index < threadCount; ++index) threads.emplace_back([this](){ Work(); });
+            }
+
+            void Work() {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock guard(mutex);
+                        wakeup.wait(guard, [this](){ return !tasks.empty(); });
+                        task = std::move(tasks.front());
+                        tasks.pop_front();
+                    }
+                    task();
+                }
+            }
+    };
+
+    /**
+     * Invokes 'body' for every index in '[0, count)' using up to 'threads' threads (0 ~> hardware concurrency), the
+     * calling one included, and blocks until all invocations returned. Helpers are taken from the 'ThreadPool', also
+     * on pool threads, so nesting does not multiply threads. The calling thread works through the indices itself and
+     * helpers only take the indices left when they start. Hence, waiting never depends on tasks still queued and
+     * nesting cannot deadlock; with the pool busy, the calling thread simply makes all invocations. If invocations
+     * throw, the exception of the smallest index is rethrown, as if the invocations were made in order; unlike a
+     * loop, the invocations after it are made nevertheless.
+     */
+    template<typename F>
+    void ParallelFor(std::size_t count, std::size_t threads, const F& body) {
+        std::vector<std::exception_ptr> errors(count);
+        auto invoke = [&body, &errors](std::size_t index) {
+            try {
+                body(index);
+            } catch (...) {
+                errors.at(index) = std::current_exception();
+            }
+        };
+
+        auto helperCount = std::min({ GetConcurrency(threads), count, ThreadPool::Get().GetThreadCount() + 1 });
+        helperCount = std::max<std::size_t>(helperCount, 1) - 1;
+
+        if (helperCount == 0) {
+            for (std::size_t index = 0; index < count; ++index) invoke(index);
+        } else {
+            struct State {
+                std::atomic<std::size_t> next = 0;
+                std::size_t finished = 0;
+                std::mutex mutex;
+                std::condition_variable done;
+            };
+            auto state = std::make_shared<State>();
+            // helpers starting late find no index left, they never use 'invoke' after the caller returned
+            auto work = [state, count, &invoke]() {
+                for (auto index = state->next++; index < count; index = state->next++) {
+                    invoke(index);
+                    std::lock_guard guard(state->mutex);
+                    if (++state->finished == count) state->done.notify_all();
+                }
+            };
+            for (std::size_t index = 0; index < helperCount; ++index) ThreadPool::Get().Submit(work);
+            work();
+            std::unique_lock guard(state->mutex);
+            state->done.wait(guard, [&state, count](){ return state->finished == count; });
+        }
+
+        for (auto& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+    }
+
+} // namespace plankton
+
+#endif //PLANKTON_UTIL_PARALLEL_HPP
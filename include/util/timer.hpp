@@ -2,6 +2,7 @@
 #ifndef PLANKTON_UTIL_TIMER_HPP
 #define PLANKTON_UTIL_TIMER_HPP
 
+#include <atomic>
 #include <chrono>
 #include <sstream>
 #include "log.hpp"
@@ -11,12 +12,12 @@ namespace plankton {
     class Timer {
     private:
         std::string info;
-        std::size_t counter;
-        std::chrono::milliseconds elapsed;
+        std::atomic<std::size_t> counter; // measurements may be taken from several threads
+        std::atomic<std::chrono::milliseconds::rep> elapsed;
 
         [[nodiscard]] inline std::string ToString(const std::string& note, bool sortable = false) const {
             std::stringstream stream;
-            auto milli = std::to_string(elapsed.count());
+            auto milli = std::to_string(elapsed.load());
             if (sortable) stream << "[" << std::string(10 - milli.length(), '0') << milli << "ms] ";
             stream << note << " '" << info << "' (" << counter << "): ";
             stream << milli << "ms";
@@ -37,7 +38,7 @@ namespace plankton {
             ~Measurement() {
                 auto end = std::chrono::steady_clock::now();
                 auto myElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-                parent.elapsed += myElapsed;
+                parent.elapsed += myElapsed.count();
                 parent.counter++;
                 // DEBUG("$MEASUREMENT for " << parent.info << ": " << myElapsed.count() << "ms" << std::endl)
             }
@@ -0,0 +1,19 @@
+#!/bin/bash
+
+CORPUS=${1:-corpus.smt2}
+FILE=${2:-params.txt}
+
+rm -f $CORPUS
+
+./plankton --smtRecord $CORPUS programs/Fine.txt
+./plankton --smtRecord $CORPUS programs/Lazy.txt
+./plankton --smtRecord $CORPUS programs/VY-DCAS.txt
+./plankton --smtRecord $CORPUS programs/VY-CAS.txt
+./plankton --smtRecord $CORPUS programs/ORVYY.txt
+./plankton --smtRecord $CORPUS programs/Michael.txt
+./plankton --smtRecord $CORPUS programs/MichaelWF.txt
+./plankton --smtRecord $CORPUS programs/Harris.txt
+./plankton --smtRecord $CORPUS programs/HarrisWF.txt
+./plankton --smtRecord $CORPUS programs/FEMRS.txt
+
+./plankton-tune -o $FILE $CORPUS
@@ -0,0 +1,42 @@
+#include "async.hpp"
+
+#include "internal.hpp"
+#include "util/parallel.hpp"
+
+using namespace plankton;
+
+
+SolvingService& SolvingService::Get() {
+    // never destroyed: the threads block on 'wakeup' until the process exits
+    static auto* service = new SolvingService(GetConcurrency(GetEncodingSetup().proofThreadCount));
+    return *service;
+}
+
+SolvingService::SolvingService(std::size_t threadCount) {
+    threads.reserve(threadCount);
+    for (std::size_t index = 0; index < threadCount; ++index) threads.emplace_back([this](){ Work(); });
+}
+
+std::future<std::vector<bool>> SolvingService::Submit(std::function<std::vector<bool>()> task) {
+    Task packaged(std::move(task));
+    auto result = packaged.get_future();
+    {
+        std::lock_guard guard(mutex);
+        tasks.push_back(std::move(packaged));
+    }
+    wakeup.notify_one();
+    return result;
+}
+
+void SolvingService::Work() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock guard(mutex);
+            wakeup.wait(guard, [this](){ return !tasks.empty(); });
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task(); // exceptions are stored in the task's future
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#ifndef PLANKTON_ENGINE_ASYNC_HPP
+#define PLANKTON_ENGINE_ASYNC_HPP
+
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+namespace plankton {
+
+    /**
+     * Process-wide threads solving the batches handed over by 'Encoding::CheckAsync' in submission order. There is
+     * one thread per API function verified concurrently, see 'EngineSetup::proofThreadCount'.
+     * Tasks must not share state with their submitter, in particular no 'z3::context'.
+     */
+    struct SolvingService final {
+        using Task = std::packaged_task<std::vector<bool>()>;
+
+        static SolvingService& Get();
+
+        SolvingService(const SolvingService& other) = delete;
+        SolvingService& operator=(const SolvingService& other) = delete;
+
+        std::future<std::vector<bool>> Submit(std::function<std::vector<bool>()> task);
+
+        private:
+            std::mutex mutex;
+            std::condition_variable wakeup;
+            std::deque<Task> tasks;
+            std::vector<std::thread> threads;
+
+            explicit SolvingService(std::size_t threadCount);
+            void Work();
+    };
+
+} // namespace plankton
+
+#endif //PLANKTON_ENGINE_ASYNC_HPP
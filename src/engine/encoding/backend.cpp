@@ -0,0 +1,129 @@
+#include "backend.hpp"
+
+#include <mutex>
+#include <sstream>
+#include "util/log.hpp"
+#include "util/timer.hpp"
+
+#ifdef PLANKTON_WITH_CVC5
+    #include <cvc5/cvc5.h>
+    #include <cvc5/cvc5_parser.h>
+#endif
+
+using namespace plankton;
+
+static constexpr const char* CHECK_PREFIX = "__chk__";
+
+
+bool plankton::IsBackendAvailable(SmtBackend backend) {
+    switch (backend) {
+        case SmtBackend::Z3: return true;
+        case SmtBackend::CVC5:
+            #ifdef PLANKTON_WITH_CVC5
+                return true;
+            #else
+                return false;
+            #endif
+    }
+    return false;
+}
+
+SmtBackend plankton::GetBackend(const std::string& category) {
+    const auto& setup = GetEncodingSetup();
+    auto find = setup.smtBackendByCategory.find(category);
+    auto result = find != setup.smtBackendByCategory.end() ? find->second : setup.smtBackend;
+    if (IsBackendAvailable(result)) return result;
+
+    static std::once_flag warning;
+    std::call_once(warning, [](){
+        WARNING("SMT backend CVC5 is not available in this build, using Z3 instead." << std::endl)
+    });
+    return SmtBackend::Z3;
+}
+
+
+//
+// CVC5
+//
+
+inline std::string GetCheckName(std::size_t index) {
+    return CHECK_PREFIX + std::to_string(index);
+}
+
+inline std::string MakeScript(const z3::expr& premise, const std::deque<EExpr>& checks) {
+    // checks are named by definitions, so that Z3 declares all their symbols
+    auto& context = premise.ctx();
+    z3::solver solver(context);
+    solver.add(premise);
+    for (std::size_t index = 0; index < checks.size(); ++index) {
+        solver.add(context.bool_const(GetCheckName(index).c_str()) == AsExpr(checks.at(index)));
+    }
+
+    std::stringstream result;
+    result << "(set-logic ALL)" << std::endl;
+    std::stringstream benchmark(solver.to_smt2());
+    std::string line;
+    while (std::getline(benchmark, line)) {
+        if (line.rfind("(check-sat)", 0) == 0) continue;
+        result << line << std::endl;
+    }
+    for (std::size_t index = 0; index < checks.size(); ++index) {
+        result << "(push 1)" << std::endl;
+        result << "(assert (not " << GetCheckName(index) << "))" << std::endl;
+        result << "(check-sat)" << std::endl;
+        result << "(pop 1)" << std::endl;
+    }
+    return result.str();
+}
+
+#ifdef PLANKTON_WITH_CVC5
+
+inline std::vector<std::optional<bool>> RunCvc5(const std::string& script, std::size_t count) {
+    cvc5::TermManager manager;
+    cvc5::Solver solver(manager);
+    solver.setOption("incremental", "true");
+    if (auto timeout = GetEncodingSetup().smtTimeout) solver.setOption("tlimit-per", std::to_string(timeout));
+
+    cvc5::parser::SymbolManager symbols(manager);
+    cvc5::parser::InputParser parser(&solver, &symbols);
+    parser.setStringInput(cvc5::modes::InputLanguage::SMT_LIB_2_6, script, "plankton");
+    std::stringstream output;
+    while (true) {
+        auto command = parser.nextCommand();
+        if (command.isNull()) break;
+        command.invoke(&solver, &symbols, output);
+    }
+
+    // one answer per 'check-sat', the checks' negations are unsatisfiable iff the checks are implied
+    std::vector<std::optional<bool>> result;
+    std::string line;
+    while (std::getline(output, line)) {
+        if (line == "unsat") result.emplace_back(true);
+        else if (line == "sat") result.emplace_back(false);
+        else if (line == "unknown") result.emplace_back(std::nullopt);
+    }
+    if (result.size() != count) throw std::logic_error("Unexpected output from CVC5."); // TODO: better error handling
+    return result;
+}
+
+#else
+
+inline std::vector<std::optional<bool>> RunCvc5(const std::string& /*script*/, std::size_t /*count*/) {
+    throw std::logic_error("CVC5 is not available in this build."); // TODO: better error handling
+}
+
+#endif
+
+std::vector<std::optional<bool>> plankton::ComputeImpliedWithCvc5(const z3::expr& premise,
+                                                                  const std::deque<EExpr>& checks) {
+    MEASURE("ComputeImplied ~> Cvc5")
+    try {
+        return RunCvc5(MakeScript(premise, checks), checks.size());
+    } catch (const std::exception& err) {
+        static std::once_flag warning;
+        std::call_once(warning, [&err](){
+            WARNING("CVC5 failed on a query, falling back to Z3: " << err.what() << std::endl)
+        });
+    }
+    return std::vector<std::optional<bool>>(checks.size(), std::nullopt);
+}
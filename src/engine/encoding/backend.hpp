@@ -0,0 +1,27 @@
+#pragma once
+#ifndef PLANKTON_ENGINE_BACKEND_HPP
+#define PLANKTON_ENGINE_BACKEND_HPP
+
+#include <optional>
+#include "internal.hpp"
+
+namespace plankton {
+
+    [[nodiscard]] bool IsBackendAvailable(SmtBackend backend);
+
+    /**
+     * The backend for queries of the given category, see 'EngineSetup::smtBackendByCategory'.
+     * Falls back to Z3 if the requested backend is not available in this build.
+     */
+    [[nodiscard]] SmtBackend GetBackend(const std::string& category);
+
+    /**
+     * Decides with CVC5 which of the 'checks' are implied by 'premise'. Queries are handed over as SMT-LIB,
+     * so the backend works on the encoding that is built for Z3. Checks CVC5 cannot decide, e.g., because
+     * the encoding uses Z3-specific extensions or CVC5 returned 'unknown', are left for Z3 as 'std::nullopt'.
+     */
+    std::vector<std::optional<bool>> ComputeImpliedWithCvc5(const z3::expr& premise, const std::deque<EExpr>& checks);
+
+} // namespace plankton
+
+#endif //PLANKTON_ENGINE_BACKEND_HPP
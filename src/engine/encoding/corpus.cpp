@@ -0,0 +1,211 @@
+#include "engine/corpus.hpp"
+
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <fstream>
+#include "internal.hpp"
+
+using namespace plankton;
+
+static constexpr const char* CHECK_PREFIX = "__chk__";
+static constexpr const char* MARKER_ENTRY = ";; @entry";
+static constexpr const char* MARKER_PREMISE = ";; @premise";
+static constexpr const char* MARKER_CHECKS = ";; @checks";
+static constexpr const char* MARKER_END = ";; @end";
+
+
+struct MalformedCorpus : std::logic_error {
+    explicit MalformedCorpus(const std::string& reason) : std::logic_error("Malformed SMT corpus: " + reason + ".") {}
+};
+
+std::string plankton::ToString(CorpusEntry::Kind kind) {
+    switch (kind) {
+        case CorpusEntry::CHECK: return "check";
+        case CorpusEntry::IMPLIES: return "implies";
+        case CorpusEntry::UNSAT: return "unsat";
+    }
+    throw;
+}
+
+inline CorpusEntry::Kind MakeKind(const std::string& string) {
+    if (string == "check") return CorpusEntry::CHECK;
+    if (string == "implies") return CorpusEntry::IMPLIES;
+    if (string == "unsat") return CorpusEntry::UNSAT;
+    throw MalformedCorpus("unknown entry kind '" + string + "'");
+}
+
+
+//
+// Recording
+//
+
+struct Recorder {
+    std::mutex mutex;
+    std::string path;
+    std::ofstream stream;
+
+    inline void Write(const std::string& target, const std::string& entry) {
+        std::lock_guard guard(mutex);
+        if (path != target) {
+            if (stream.is_open()) stream.close();
+            stream.open(target, std::ios::app); // runs accumulate into one corpus
+            path = target;
+        }
+        stream << entry << std::flush;
+    }
+};
+
+inline Recorder& GetRecorder() {
+    static Recorder recorder;
+    return recorder;
+}
+
+inline std::string MakeCategoryTag(std::string category) {
+    if (category.empty()) return "-";
+    for (auto& chr : category) if (std::isspace(chr)) chr = '_';
+    return category;
+}
+
+inline std::string MakeResultTag(const std::vector<bool>& results) {
+    if (results.empty()) return "-";
+    std::string result;
+    for (bool elem : results) result.push_back(elem ? '1' : '0');
+    return result;
+}
+
+bool plankton::IsRecordingQueries() {
+    return !GetEncodingSetup().smtRecordPath.empty();
+}
+
+void plankton::RecordQuery(CorpusEntry::Kind kind, const std::string& category, z3::solver& solver,
+                           const std::deque<EExpr>& checks, const std::vector<bool>& results,
+                           std::chrono::microseconds time) {
+    auto& context = solver.ctx();
+    z3::solver premise(context);
+    for (const auto& assertion : solver.assertions()) {
+        if (IsSelectorAssertion(assertion)) continue;
+        premise.add(assertion);
+    }
+    z3::solver encodedChecks(context);
+    for (std::size_t index = 0; index < checks.size(); ++index) {
+        auto name = CHECK_PREFIX + std::to_string(index);
+        encodedChecks.add(context.bool_const(name.c_str()) == AsExpr(checks.at(index)));
+    }
+
+    std::stringstream entry;
+    entry << MARKER_ENTRY << " " << ToString(kind) << " " << MakeCategoryTag(category) << " " << time.count()
+          << " " << MakeResultTag(results) << std::endl;
+    entry << MARKER_PREMISE << std::endl << premise.to_smt2();
+    entry << MARKER_CHECKS << std::endl << encodedChecks.to_smt2();
+    entry << MARKER_END << std::endl;
+    GetRecorder().Write(GetEncodingSetup().smtRecordPath, entry.str());
+}
+
+
+//
+// Reading
+//
+
+inline bool StartsWith(const std::string& string, const std::string& prefix) {
+    return string.rfind(prefix, 0) == 0;
+}
+
+inline std::vector<bool> ParseResults(const std::string& string) {
+    std::vector<bool> result;
+    if (string == "-") return result;
+    for (auto chr : string) {
+        if (chr != '0' && chr != '1') throw MalformedCorpus("unexpected result '" + string + "'");
+        result.push_back(chr == '1');
+    }
+    return result;
+}
+
+inline std::string ReadUntil(std::istream& stream, const std::string& marker) {
+    std::string line;
+    std::stringstream result;
+    while (std::getline(stream, line)) {
+        if (line == marker) return result.str();
+        result << line << std::endl;
+    }
+    throw MalformedCorpus("missing '" + marker + "'");
+}
+
+std::optional<CorpusEntry> plankton::ReadCorpusEntry(std::istream& stream) {
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!StartsWith(line, MARKER_ENTRY)) continue;
+
+        CorpusEntry entry;
+        std::stringstream header(line.substr(std::string(MARKER_ENTRY).size()));
+        std::string kind, results;
+        long long time;
+        if (!(header >> kind >> entry.category >> time >> results)) throw MalformedCorpus("bad header '" + line + "'");
+        entry.kind = MakeKind(kind);
+        entry.time = std::chrono::microseconds(time);
+        entry.results = ParseResults(results);
+
+        ReadUntil(stream, MARKER_PREMISE);
+        entry.premise = ReadUntil(stream, MARKER_CHECKS);
+        entry.checks = ReadUntil(stream, MARKER_END);
+        return entry;
+    }
+    return std::nullopt;
+}
+
+
+//
+// Replaying
+//
+
+std::deque<EExpr> Encoding::ParseChecks(const std::string& smtLib) {
+    auto& context = AsContext(internal);
+    auto assertions = context.parse_string(smtLib.c_str());
+    std::map<std::size_t, z3::expr> checks;
+    for (const auto& assertion : assertions) {
+        if (!assertion.is_eq() || !assertion.arg(0).is_const()) throw MalformedCorpus("unexpected check");
+        auto name = assertion.arg(0).decl().name().str();
+        if (!StartsWith(name, CHECK_PREFIX)) throw MalformedCorpus("unexpected check '" + name + "'");
+        auto index = std::stoul(name.substr(std::string(CHECK_PREFIX).size()));
+        checks.emplace(index, assertion.arg(1));
+    }
+
+    std::deque<EExpr> result;
+    for (const auto& [index, check] : checks) {
+        if (index != result.size()) throw MalformedCorpus("missing check " + std::to_string(result.size()));
+        result.push_back(AsEExpr(check));
+    }
+    return result;
+}
+
+inline std::vector<bool> Solve(Encoding& encoding, CorpusEntry::Kind kind, const std::deque<EExpr>& checks) {
+    switch (kind) {
+        case CorpusEntry::CHECK: {
+            std::vector<bool> result(checks.size(), false);
+            for (std::size_t index = 0; index < checks.size(); ++index) {
+                encoding.AddCheck(checks.at(index), [&result, index](bool holds){ result.at(index) = holds; });
+            }
+            encoding.Check();
+            return result;
+        }
+        case CorpusEntry::IMPLIES:
+            if (checks.size() != 1) throw MalformedCorpus("expected a single check");
+            return { encoding.Implies(checks.front()) };
+        case CorpusEntry::UNSAT:
+            return { encoding.ImpliesFalse() };
+    }
+    throw;
+}
+
+CorpusReplay plankton::ReplayCorpusEntry(const CorpusEntry& entry) {
+    Encoding encoding(entry.premise);
+    encoding.SetCategory(entry.category);
+    auto checks = encoding.ParseChecks(entry.checks);
+
+    CorpusReplay result;
+    auto begin = std::chrono::steady_clock::now();
+    result.results = Solve(encoding, entry.kind, checks);
+    auto end = std::chrono::steady_clock::now();
+    result.time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
+    return result;
+}
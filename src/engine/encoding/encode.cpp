@@ -1,6 +1,7 @@
 #include "engine/encoding.hpp"
 
 #include "internal.hpp"
+#include "outflow.hpp"
 #include "logics/util.hpp"
 #include "engine/util.hpp"
 
@@ -14,23 +15,46 @@ static constexpr int NULL_VALUE = 0;
 static constexpr int MIN_VALUE = -65536;
 static constexpr int MAX_VALUE = 65536;
 static constexpr int UNLOCKED_VALUE = 0;
+static constexpr unsigned int DATA_BIT_WIDTH = 18; // holds MIN_VALUE and MAX_VALUE as signed values
+
+inline bool UseFiniteDomain() {
+    return GetEncodingSetup().smtFiniteDomain;
+}
+
+inline bool UseUninterpretedSorts() {
+    return GetEncodingSetup().smtUninterpretedSorts;
+}
 
 inline z3::sort EncodeSort(Sort sort, z3::context& context) {
     switch (sort) {
         case Sort::BOOL: return context.bool_sort();
+        case Sort::DATA: if (UseFiniteDomain()) return context.bv_sort(DATA_BIT_WIDTH); else return context.int_sort();
+        case Sort::PTR: if (UseUninterpretedSorts()) return context.uninterpreted_sort("Ptr"); else return context.int_sort();
+        case Sort::TID: if (UseUninterpretedSorts()) return context.uninterpreted_sort("Tid"); else return context.int_sort();
         default: return context.int_sort();
     }
 }
 
+inline z3::expr EncodeDataValue(int value, z3::context& context) {
+    if (UseFiniteDomain()) return context.bv_val(value, DATA_BIT_WIDTH);
+    return context.int_val(value);
+}
 
-EExpr Encoding::Min() { return AsEExpr(CTX.int_val(MIN_VALUE)); }
-EExpr Encoding::Max() { return AsEExpr(CTX.int_val(MAX_VALUE)); }
-EExpr Encoding::Null() { return AsEExpr(CTX.int_val(NULL_VALUE)); }
+
+EExpr Encoding::Min() { return AsEExpr(EncodeDataValue(MIN_VALUE, CTX)); }
+EExpr Encoding::Max() { return AsEExpr(EncodeDataValue(MAX_VALUE, CTX)); }
+EExpr Encoding::Null() {
+    if (UseUninterpretedSorts()) return AsEExpr(CTX.constant("__NULL", EncodeSort(Sort::PTR, CTX)));
+    return AsEExpr(CTX.int_val(NULL_VALUE));
+}
 EExpr Encoding::Bool(bool val) { return AsEExpr(CTX.bool_val(val)); }
 
 EExpr Encoding::TidSelf() { return AsEExpr(CTX.constant("__SELF", EncodeSort(Sort::TID, CTX))); }
 EExpr Encoding::TidSome() { return AsEExpr(CTX.constant("__SOME", EncodeSort(Sort::TID, CTX))); }
-EExpr Encoding::TidUnlocked() { return AsEExpr(CTX.int_val(UNLOCKED_VALUE)); }
+EExpr Encoding::TidUnlocked() {
+    if (UseUninterpretedSorts()) return AsEExpr(CTX.constant("__UNLOCKED", EncodeSort(Sort::TID, CTX)));
+    return AsEExpr(CTX.int_val(UNLOCKED_VALUE));
+}
 
 EExpr Encoding::Replace(const EExpr& expression, const EExpr& replace, const EExpr& with) {
     z3::expr_vector replaceVec(CTX), withVec(CTX);
@@ -97,7 +121,8 @@ EExpr Encoding::Encode(const SymbolDeclaration& decl) {
                         SOL.add(expr <= AsExpr(Max()));
                         break;
                     case Sort::TID:
-                        SOL.add(AsExpr(TidUnlocked()) <= expr);
+                        // uninterpreted thread ids are unordered, the background axioms suffice
+                        if (!UseUninterpretedSorts()) SOL.add(AsExpr(TidUnlocked()) <= expr);
                         break;
                     default: break;
                 }
@@ -107,15 +132,17 @@ EExpr Encoding::Encode(const SymbolDeclaration& decl) {
     
         case Order::SECOND:
             return GetOrCreate(symbolEncoding, &decl, [this, &decl]() {
-                // create symbol
+                // create symbol, finite domains use arrays such that flow (in)equalities need no quantifiers
                 auto name = "_V" + decl.name;
-                auto expr = CTX.function(name.c_str(), EncodeSort(decl.type.sort, CTX), CTX.bool_sort());
+                auto sort = EncodeSort(decl.type.sort, CTX);
+                auto expr = UseFiniteDomain() ? AsEExpr(CTX.constant(name.c_str(), CTX.array_sort(sort, CTX.bool_sort())))
+                                              : AsEExpr(CTX.function(name.c_str(), sort, CTX.bool_sort()));
                 // add implicit bounds on data values
                 assert(decl.type.sort == Sort::DATA);
-                auto qv = AsExpr(MakeQuantifiedVariable(decl.type.sort));
-                SOL.add(z3::forall(qv, z3::implies(qv < AsExpr(Min()), !expr(qv))));
-                SOL.add(z3::forall(qv, z3::implies(qv > AsExpr(Max()), !expr(qv))));
-                return AsEExpr(expr);
+                auto qv = MakeQuantifiedVariable(decl.type.sort);
+                SOL.add(z3::forall(AsExpr(qv), AsExpr((qv < Min()) >> !expr(qv))));
+                SOL.add(z3::forall(AsExpr(qv), AsExpr((qv > Max()) >> !expr(qv))));
+                return expr;
             });
     }
     throw;
@@ -258,9 +285,40 @@ struct FormulaEncoder : public BaseLogicVisitor {
     }
 };
 
+inline bool IsCompound(const LogicObject& object) {
+    return dynamic_cast<const SeparatingConjunction*>(&object)
+           || dynamic_cast<const NonSeparatingImplication*>(&object)
+           || dynamic_cast<const ImplicationSet*>(&object);
+}
+
 EExpr Encoding::Encode(const LogicObject& object) {
-    FormulaEncoder encoder(*this);
-    return encoder.Encode(object);
+    // axioms are cheap to encode, only compound formulas are worth hashing and copying; their parts are encoded
+    // directly, see 'FormulaEncoder', such that only the formula handed to 'Encode' is hashed and copied
+    if (!IsCompound(object)) return FormulaEncoder(*this).Encode(object);
+
+    // objects are often encoded repeatedly, try the entry matched last by the object's address; addresses may be
+    // reused by other objects, so the entry is confirmed before use, which spares hashing the object
+    auto byAddress = formulaEncodingByAddress.find(&object);
+    if (byAddress != formulaEncodingByAddress.end()) {
+        const auto& [copy, expr] = *byAddress->second;
+        if (plankton::SyntacticalEqual(*copy, object)) return expr;
+    }
+
+    auto hash = plankton::SyntacticalHash(object);
+    auto range = formulaEncoding.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (!plankton::SyntacticalEqual(*it->second.first, object)) continue;
+        formulaEncodingByAddress[&object] = &it->second;
+        return it->second.second;
+    }
+
+    // symbols encountered for the first time add their bounds to the solver, so hits need not redo that;
+    // most formulas are encoded once, copying them pays off only for the ones that reoccur
+    auto result = FormulaEncoder(*this).Encode(object);
+    if (formulaHashes.insert(hash).second) return result;
+    auto entry = formulaEncoding.emplace(hash, std::make_pair(plankton::Copy(object), result));
+    formulaEncodingByAddress[&object] = &entry->second;
+    return result;
 }
 
 EExpr Encoding::EncodeFormulaWithKnowledge(const Formula& formula, const SolverConfig& config) {
@@ -278,10 +336,10 @@ EExpr Encoding::EncodeInvariants(const Formula& formula, const SolverConfig& con
     auto variables = plankton::Collect<EqualsToAxiom>(formula);
     std::vector<EExpr> result;
     result.reserve(local.size() + shared.size() + variables.size());
-    for (const auto* mem : local) result.push_back(Encode(*config.GetLocalNodeInvariant(*mem)));
-    for (const auto* mem : shared) result.push_back(Encode(*config.GetSharedNodeInvariant(*mem)));
+    for (const auto* mem : local) result.push_back(EncodeInvariant(*mem, config));
+    for (const auto* mem : shared) result.push_back(EncodeInvariant(*mem, config));
     for (const auto* var : variables)
-        if (var->Variable().isShared) result.push_back(Encode(*config.GetSharedVariableInvariant(*var)));
+        if (var->Variable().isShared) result.push_back(EncodeInvariant(*var, config));
     return MakeAnd(result);
 }
 
@@ -341,9 +399,10 @@ EExpr Encoding::EncodeSimpleFlowRules(const Formula& formula, const SolverConfig
                 if (memory == other) continue;
                 if (value->Decl() != other->node->Decl()) continue;
                 auto inflowOther = Encode(*other->flow);
+                OutflowPredicate outflow(*this, *memory, name, config);
                 for (const auto* symbol : symbols) {
-                    auto flowsOut = Encode(*config.GetOutflowContains(*memory, name, *symbol));
                     auto encSym = Encode(*symbol);
+                    auto flowsOut = outflow.Contains(encSym);
                     auto rule1 = (inflowMemory(encSym) && flowsOut) >> inflowOther(encSym);
                     auto rule2 = Bool(true); // inflowMemory(encSym) && inflowOther(encSym)) >> flowsOut; // this relies on inflow uniqueness // TODO: is it even correct?? ~~> most certainly not
                     result.push_back(rule1 && rule2);
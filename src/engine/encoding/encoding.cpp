@@ -1,5 +1,6 @@
 #include "engine/encoding.hpp"
 
+#include <mutex>
 #include "internal.hpp"
 
 using namespace plankton;
@@ -9,45 +10,171 @@ using namespace plankton;
 // EExpr
 //
 
-EExpr EExpr::operator!() const { return EExpr(repr->Negate()); }
-EExpr EExpr::operator&&(const EExpr& other) const { return EExpr(repr->And(*other.repr)); }
-EExpr EExpr::operator||(const EExpr& other) const { return EExpr(repr->Or(*other.repr)); }
-EExpr EExpr::operator==(const EExpr& other) const { return EExpr(repr->Eq(*other.repr)); }
-EExpr EExpr::operator!=(const EExpr& other) const { return EExpr(repr->Neq(*other.repr)); }
-EExpr EExpr::operator<(const EExpr& other) const { return EExpr(repr->Lt(*other.repr)); }
-EExpr EExpr::operator<=(const EExpr& other) const { return EExpr(repr->Leq(*other.repr)); }
-EExpr EExpr::operator>(const EExpr& other) const { return EExpr(repr->Gt(*other.repr)); }
-EExpr EExpr::operator>=(const EExpr& other) const { return EExpr(repr->Geq(*other.repr)); }
-EExpr EExpr::operator>>(const EExpr& other) const { return EExpr(repr->Implies(*other.repr)); }
-EExpr EExpr::operator()(const EExpr& other) const { return EExpr(repr->Contains(*other.repr)); }
+inline EExpr FuncDeclEq(const z3::func_decl& decl, const z3::func_decl& other) {
+    // TODO: is this too much of a hack?
+    assert(decl.arity() == 1);
+    assert(other.arity() == 1);
+    assert(z3::eq(decl.domain(0), other.domain(0)));
+    auto qv = decl.ctx().constant("__op-qv", decl.domain(0));
+    return AsEExpr(z3::forall(qv, decl(qv) == other(qv)));
+}
+
+EExpr EExpr::operator!() const { return AsEExpr(!AsExpr(*this)); }
+EExpr EExpr::operator&&(const EExpr& other) const { return AsEExpr(AsExpr(*this) && AsExpr(other)); }
+EExpr EExpr::operator||(const EExpr& other) const { return AsEExpr(AsExpr(*this) || AsExpr(other)); }
+EExpr EExpr::operator<(const EExpr& other) const { return AsEExpr(AsExpr(*this) < AsExpr(other)); }
+EExpr EExpr::operator<=(const EExpr& other) const { return AsEExpr(AsExpr(*this) <= AsExpr(other)); }
+EExpr EExpr::operator>(const EExpr& other) const { return AsEExpr(AsExpr(*this) > AsExpr(other)); }
+EExpr EExpr::operator>=(const EExpr& other) const { return AsEExpr(AsExpr(*this) >= AsExpr(other)); }
+EExpr EExpr::operator>>(const EExpr& other) const { return AsEExpr(z3::implies(AsExpr(*this), AsExpr(other))); }
+
+EExpr EExpr::operator==(const EExpr& other) const {
+    if (IsFuncDecl(*this)) return FuncDeclEq(AsFuncDecl(*this), AsFuncDecl(other));
+    return AsEExpr(AsExpr(*this) == AsExpr(other));
+}
 
-const InternalExpr& EExpr::Repr() const { return *repr; }
+EExpr EExpr::operator!=(const EExpr& other) const {
+    if (IsFuncDecl(*this)) return !FuncDeclEq(AsFuncDecl(*this), AsFuncDecl(other));
+    return AsEExpr(AsExpr(*this) != AsExpr(other));
+}
 
-EExpr::EExpr(std::unique_ptr<InternalExpr> repr_) : repr(std::move(repr_)) {
-    assert(repr);
+EExpr EExpr::operator()(const EExpr& other) const {
+    if (IsFuncDecl(*this)) return AsEExpr(AsFuncDecl(*this)(AsExpr(other)));
+    // flows are arrays rather than functions if 'EngineSetup::smtFiniteDomain' is set
+    auto expr = AsExpr(*this);
+    if (!expr.is_array()) throw InternalEncodingError("'z3::expr' supports 'operator()' for arrays only");
+    return AsEExpr(z3::select(expr, AsExpr(other)));
 }
 
-EExpr::EExpr(const EExpr& other) : EExpr(other.repr->Copy()) {
+EExpr::EExpr(Kind kind) : kind(kind) {
+}
+
+EExpr::EExpr(const EExpr& other) : kind(other.kind) {
+    new (storage) z3::ast(InternalExprAccess::Handle(other));
+}
+
+EExpr::EExpr(EExpr&& other) noexcept : kind(other.kind) {
+    new (storage) z3::ast(std::move(InternalExprAccess::Handle(other)));
 }
 
 EExpr& EExpr::operator=(const EExpr& other) {
-    repr = other.repr->Copy();
+    InternalExprAccess::Handle(*this) = InternalExprAccess::Handle(other);
+    kind = other.kind;
     return *this;
 }
 
+EExpr& EExpr::operator=(EExpr&& other) noexcept {
+    // 'z3::ast::operator=(ast&&)' does not release the handle it overwrites
+    if (this == &other) return *this;
+    InternalExprAccess::Handle(*this).~ast();
+    new (storage) z3::ast(std::move(InternalExprAccess::Handle(other)));
+    kind = other.kind;
+    return *this;
+}
+
+EExpr::~EExpr() {
+    InternalExprAccess::Handle(*this).~ast();
+}
+
 //
-// Encoding
+// Setup
+//
+
+inline std::shared_ptr<const EngineSetup>& GetSetupStorage() {
+    static std::shared_ptr<const EngineSetup> setup = std::make_shared<EngineSetup>();
+    return setup;
+}
+
+void plankton::SetupEncoding(std::shared_ptr<const EngineSetup> setup) {
+    assert(setup);
+    GetSetupStorage() = std::move(setup);
+}
+
+const EngineSetup& plankton::GetEncodingSetup() {
+    return *GetSetupStorage();
+}
+
+
 //
+// Storage pool
+//
+
+static constexpr std::size_t MAX_POOLED_STORAGES = 32;
+
+struct StoragePool {
+    std::mutex mutex;
+    std::deque<std::unique_ptr<InternalStorage>> storages;
+};
 
-Encoding::Encoding() : internal(std::make_unique<Z3InternalStorage>()) {
-    AsSolver(internal).add(AsExpr(TidSelf() > TidUnlocked()));
-    AsSolver(internal).add(AsExpr(TidSome() > TidUnlocked()));
+inline StoragePool& GetStoragePool() {
+    static StoragePool pool;
+    return pool;
 }
 
-Encoding::Encoding(const std::string& smtLib) : internal(std::make_unique<Z3InternalStorage>()) {
+inline std::unique_ptr<InternalStorage> AcquireStorage() {
+    auto& pool = GetStoragePool();
+    std::lock_guard guard(pool.mutex);
+    if (pool.storages.empty()) return std::make_unique<Z3InternalStorage>();
+    auto result = std::move(pool.storages.back());
+    pool.storages.pop_back();
+    return result;
+}
+
+inline void ReleaseStorage(std::unique_ptr<InternalStorage> internal) {
+    if (!internal) return;
+    auto& storage = AsInternal(internal);
+    if (!storage.hasBackground) return;
+
+    if (storage.category.empty()) {
+        // drop everything above the background axioms
+        auto& solver = storage.solver;
+        solver.pop(Z3_solver_get_num_scopes(storage.context, solver));
+        solver.push();
+    } else {
+        // parameters of the category accumulate and resetting a solver keeps them, start over with a fresh one
+        storage.solver = z3::solver(storage.context);
+        storage.category.clear();
+        storage.hasBackground = false; // re-asserted by the next 'Encoding', see its constructor
+        SetBudget(storage.solver);
+    }
+
+    auto& pool = GetStoragePool();
+    std::lock_guard guard(pool.mutex);
+    if (pool.storages.size() >= MAX_POOLED_STORAGES) return;
+    pool.storages.push_back(std::move(internal));
+}
+
+
+//
+// Encoding
+//
+
+Encoding::Encoding() : internal(AcquireStorage()) {
+    auto& storage = AsInternal(internal);
+    if (storage.hasBackground) return;
+    if (GetEncodingSetup().smtUninterpretedSorts) {
+        storage.solver.add(AsExpr(TidSelf() != TidUnlocked()));
+        storage.solver.add(AsExpr(TidSome() != TidUnlocked()));
+    } else {
+        storage.solver.add(AsExpr(TidSelf() > TidUnlocked()));
+        storage.solver.add(AsExpr(TidSome() > TidUnlocked()));
+    }
+    storage.solver.push();
+    storage.hasBackground = true;
+}
+
+Encoding::Encoding(const std::string& smtLib) : Encoding() {
     AsSolver(internal).from_string(smtLib.c_str());
-    AsSolver(internal).add(AsExpr(TidSelf() > TidUnlocked()));
-    AsSolver(internal).add(AsExpr(TidSome() > TidUnlocked()));
+}
+
+Encoding::~Encoding() {
+    // expressions must not outlive their context, which is destroyed if the storage is not pooled
+    checks_premise.clear();
+    checks_callback.clear();
+    variableEncoding.clear();
+    symbolEncoding.clear();
+    formulaEncoding.clear();
+    ReleaseStorage(std::move(internal));
 }
 
 Encoding::Encoding(const Formula& premise) : Encoding() {
@@ -87,6 +214,15 @@ void Encoding::AddCheck(const EExpr& expr, std::function<void(bool)> callback) {
     checks_callback.push_back(std::move(callback));
 }
 
+void Encoding::SetCategory(std::string category_) {
+    // parameters only ever accumulate, the ones of a previous category are not reverted; the solver is replaced
+    // once the storage is released, see 'ReleaseStorage'
+    category = std::move(category_);
+    auto& storage = AsInternal(internal);
+    storage.category = category;
+    ApplySmtParams(storage.solver, category);
+}
+
 void Encoding::Push() {
     AsSolver(internal).push();
 }
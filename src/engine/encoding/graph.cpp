@@ -1,6 +1,7 @@
 #include "engine/encoding.hpp"
 
 #include "internal.hpp"
+#include "outflow.hpp"
 #include "logics/util.hpp"
 
 using namespace plankton;
@@ -30,8 +31,9 @@ EExpr Encoding::EncodeOutflow(const FlowGraphNode& node, const PointerField& fie
     auto addRule = [this,&result,flowSort](const auto& func){
         result.push_back(AsExpr(EncodeForAll(flowSort, func)));
     };
-    auto elemOfOutflow = [&](const EExpr& value) -> EExpr {
-        return EncodeOutflowContains(node, field.name, value, mode);
+    OutflowPredicate outflow(*this, *node.ToLogic(mode), field.name, graph.config);
+    auto elemOfOutflow = [&outflow](const EExpr& value) -> EExpr {
+        return outflow.Contains(value);
     };
     
     // outflow
@@ -189,22 +191,10 @@ EExpr Encoding::EncodeLogicallyContains(const FlowGraphNode& node, const EExpr&
 }
 
 EExpr Encoding::EncodeOutflowContains(const FlowGraphNode& node, const std::string& field, const EExpr& value, EMode mode) {
-    auto [axiom, dummy] = MakeDummy(node, mode);
-    auto predicate = node.parent.config.GetOutflowContains(*axiom, field, dummy);
-    return Replace(Encode(*predicate), Encode(dummy), value);
+    OutflowPredicate outflow(*this, *node.ToLogic(mode), field, node.parent.config);
+    return outflow.Contains(value);
 }
 
-struct InvariantCreator : public BaseLogicVisitor {
-    std::unique_ptr<ImplicationSet> invariant;
-    const SolverConfig& config;
-    explicit InvariantCreator(const SolverConfig& config) : config(config) {}
-    void Visit(const LocalMemoryResource& object) override { invariant = config.GetLocalNodeInvariant(object); }
-    void Visit(const SharedMemoryCore& object) override { invariant = config.GetSharedNodeInvariant(object); }
-};
-
 EExpr Encoding::EncodeNodeInvariant(const FlowGraphNode& node, EMode mode) {
-    InvariantCreator encoder(node.parent.config);
-    node.ToLogic(mode)->Accept(encoder);
-    if (!encoder.invariant) throw std::logic_error("Internal error: cannot produce invariant for node.");
-    return Encode(*encoder.invariant);
+    return EncodeInvariant(*node.ToLogic(mode), node.parent.config);
 }
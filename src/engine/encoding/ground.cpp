@@ -0,0 +1,172 @@
+#include "ground.hpp"
+
+#include <map>
+#include <set>
+
+using namespace plankton;
+
+static constexpr std::size_t MAX_INSTANCES = 4096; // per quantifier, larger ones are kept
+static constexpr const char* SKOLEM_PREFIX = "__sk";
+
+
+inline std::vector<z3::sort> GetBoundSorts(const z3::expr& quantifier) {
+    auto& context = quantifier.ctx();
+    auto count = Z3_get_quantifier_num_bound(context, quantifier);
+    std::vector<z3::sort> result;
+    result.reserve(count);
+    for (unsigned index = 0; index < count; ++index) {
+        result.emplace_back(context, Z3_get_quantifier_bound_sort(context, quantifier, index));
+    }
+    return result;
+}
+
+inline z3::expr Instantiate(const z3::expr& quantifier, const std::vector<z3::expr>& values) {
+    // de Bruijn index 0 refers to the last bound variable
+    z3::expr_vector substitution(quantifier.ctx());
+    for (auto index = values.size(); index-- > 0;) substitution.push_back(values.at(index));
+    return quantifier.body().substitute(substitution);
+}
+
+inline bool IsComparison(const z3::expr& expr) {
+    switch (expr.decl().decl_kind()) {
+        case Z3_OP_LE: case Z3_OP_LT: case Z3_OP_GE: case Z3_OP_GT: return true;
+        case Z3_OP_SLEQ: case Z3_OP_SLT: case Z3_OP_SGEQ: case Z3_OP_SGT: return true;
+        default: return false;
+    }
+}
+
+struct Grounder {
+    using Memo = std::map<std::pair<unsigned, bool>, std::pair<z3::expr, z3::expr>>; // keeps the key alive
+
+    z3::context& context;
+    Memo skolemized, instantiated;
+    std::map<unsigned, bool> ground;
+    std::set<unsigned> visited;
+    std::map<unsigned, std::vector<z3::expr>> terms; // by sort id
+    std::set<unsigned> termIds;
+
+    explicit Grounder(z3::context& context) : context(context) {}
+
+    template<typename F>
+    z3::expr Rewrite(const z3::expr& expr, bool positive, Memo& memo, const F& handleQuantifier) {
+        auto key = std::make_pair(expr.id(), positive);
+        auto find = memo.find(key);
+        if (find != memo.end()) return find->second.second;
+        auto result = RewriteUnmemoized(expr, positive, memo, handleQuantifier);
+        memo.emplace(key, std::make_pair(expr, result));
+        return result;
+    }
+
+    template<typename F>
+    z3::expr RewriteUnmemoized(const z3::expr& expr, bool positive, Memo& memo, const F& handleQuantifier) {
+        if (expr.is_quantifier()) return handleQuantifier(expr, positive);
+        if (!expr.is_app() || !expr.is_bool()) return expr;
+
+        // descend only where the polarity is known
+        auto kind = expr.decl().decl_kind();
+        auto polarityOf = [kind,positive](unsigned index) {
+            if (kind == Z3_OP_NOT) return !positive;
+            if (kind == Z3_OP_IMPLIES && index == 0) return !positive;
+            return positive;
+        };
+        switch (kind) {
+            case Z3_OP_NOT: case Z3_OP_AND: case Z3_OP_OR: case Z3_OP_IMPLIES: break;
+            default: return expr;
+        }
+
+        bool changed = false;
+        z3::expr_vector args(context);
+        for (unsigned index = 0; index < expr.num_args(); ++index) {
+            auto arg = expr.arg(index);
+            auto newArg = Rewrite(arg, polarityOf(index), memo, handleQuantifier);
+            changed |= !z3::eq(arg, newArg);
+            args.push_back(newArg);
+        }
+        if (!changed) return expr;
+        return expr.decl()(args);
+    }
+
+    z3::expr Skolemize(const z3::expr& expr, bool positive) {
+        return Rewrite(expr, positive, skolemized, [this](const z3::expr& quantifier, bool positive) {
+            if (positive ? !quantifier.is_exists() : !quantifier.is_forall()) return quantifier;
+            std::vector<z3::expr> skolems;
+            for (const auto& sort : GetBoundSorts(quantifier)) {
+                skolems.push_back(z3::to_expr(context, Z3_mk_fresh_const(context, SKOLEM_PREFIX, sort)));
+            }
+            return Skolemize(Instantiate(quantifier, skolems), positive);
+        });
+    }
+
+    z3::expr Ground(const z3::expr& expr, bool positive) {
+        return Rewrite(expr, positive, instantiated, [this](const z3::expr& quantifier, bool positive) {
+            if (positive ? !quantifier.is_forall() : !quantifier.is_exists()) return quantifier;
+            auto sorts = GetBoundSorts(quantifier);
+            std::size_t count = 1;
+            for (const auto& sort : sorts) count *= terms[sort.id()].size();
+            if (count == 0) return context.bool_val(positive);
+            if (count > MAX_INSTANCES) return quantifier;
+
+            // enumerate all tuples of terms
+            z3::expr_vector instances(context);
+            std::vector<std::size_t> tuple(sorts.size(), 0);
+            for (std::size_t instance = 0; instance < count; ++instance) {
+                std::vector<z3::expr> values;
+                for (std::size_t index = 0; index < sorts.size(); ++index) {
+                    values.push_back(terms[sorts.at(index).id()].at(tuple.at(index)));
+                }
+                instances.push_back(Ground(Skolemize(Instantiate(quantifier, values), positive), positive));
+                for (std::size_t index = 0; index < sorts.size(); ++index) {
+                    if (++tuple.at(index) < terms[sorts.at(index).id()].size()) break;
+                    tuple.at(index) = 0;
+                }
+            }
+            return positive ? z3::mk_and(instances) : z3::mk_or(instances);
+        });
+    }
+
+    bool IsGround(const z3::expr& expr) {
+        auto find = ground.find(expr.id());
+        if (find != ground.end()) return find->second;
+        bool result = expr.is_app();
+        for (unsigned index = 0; result && index < expr.num_args(); ++index) result = IsGround(expr.arg(index));
+        ground.emplace(expr.id(), result);
+        return result;
+    }
+
+    void AddTerm(const z3::expr& expr) {
+        if (expr.is_bool() || !IsGround(expr)) return;
+        if (!termIds.insert(expr.id()).second) return;
+        terms[expr.get_sort().id()].push_back(expr);
+    }
+
+    void CollectTerms(const z3::expr& expr) {
+        if (!visited.insert(expr.id()).second) return;
+        if (expr.is_quantifier()) {
+            CollectTerms(expr.body());
+            return;
+        }
+        if (!expr.is_app()) return;
+        auto kind = expr.decl().decl_kind();
+        auto isRelevant = IsComparison(expr) || (expr.num_args() > 0 && kind == Z3_OP_UNINTERPRETED);
+        for (unsigned index = 0; index < expr.num_args(); ++index) {
+            auto arg = expr.arg(index);
+            if (isRelevant || (kind == Z3_OP_SELECT && index > 0)) AddTerm(arg);
+            CollectTerms(arg);
+        }
+    }
+};
+
+std::vector<z3::expr> plankton::GroundQuantifiers(const std::vector<z3::expr>& formulas) {
+    if (formulas.empty()) return {};
+    Grounder grounder(formulas.front().ctx());
+
+    std::vector<z3::expr> skolemized;
+    skolemized.reserve(formulas.size());
+    for (const auto& formula : formulas) skolemized.push_back(grounder.Skolemize(formula, true));
+    for (const auto& formula : skolemized) grounder.CollectTerms(formula);
+
+    std::vector<z3::expr> result;
+    result.reserve(formulas.size());
+    for (const auto& formula : skolemized) result.push_back(grounder.Ground(formula, true));
+    return result;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#ifndef PLANKTON_ENGINE_GROUND_HPP
+#define PLANKTON_ENGINE_GROUND_HPP
+
+#include "internal.hpp"
+
+namespace plankton {
+
+    /**
+     * Eliminates the quantifiers of 'formulas', which must share a context. Existential quantifiers (in the
+     * sense of their polarity) are skolemized. Universal quantifiers are replaced by their instances over the
+     * relevant ground terms of all 'formulas': the arguments of flows, i.e., uninterpreted functions or arrays,
+     * and of arithmetic comparisons, like the bounds of symbols. These are the symbols, MIN/MAX, and the keys named
+     * by obligations and contains-axioms. Quantifiers below non-boolean connectives are left untouched.
+     *
+     * The result is a weakening: if the conjunction of the results is unsatisfiable, then so is the
+     * conjunction of 'formulas'. The converse need not hold.
+     */
+    std::vector<z3::expr> GroundQuantifiers(const std::vector<z3::expr>& formulas);
+
+} // namespace plankton
+
+#endif //PLANKTON_ENGINE_GROUND_HPP
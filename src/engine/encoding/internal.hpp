@@ -2,8 +2,13 @@
 #ifndef PLANKTON_ENGINE_INTERNAL_HPP
 #define PLANKTON_ENGINE_INTERNAL_HPP
 
+#include <limits>
+#include <algorithm>
+#include <new>
 #include "z3++.h"
 #include "engine/encoding.hpp"
+#include "engine/corpus.hpp"
+#include "presolve.hpp"
 
 namespace plankton {
     
@@ -13,130 +18,127 @@ namespace plankton {
         [[nodiscard]] const char* what() const noexcept override { return msg.c_str(); }
     };
     
-    inline z3::expr AsExpr(const InternalExpr& expr);
-    inline z3::func_decl AsFuncDecl(const InternalExpr& expr);
-    
-    struct Z3Expr : public InternalExpr {
-        z3::expr repr;
-        
-        explicit Z3Expr(const z3::expr& repr) : repr(repr) {}
-    
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Negate() const override {
-            return std::make_unique<Z3Expr>(!repr);
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> And(const InternalExpr& other) const override {
-            return std::make_unique<Z3Expr>(repr && AsExpr(other));
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Or(const InternalExpr& other) const override {
-            return std::make_unique<Z3Expr>(repr || AsExpr(other));
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Eq(const InternalExpr& other) const override {
-            return std::make_unique<Z3Expr>(repr == AsExpr(other));
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Neq(const InternalExpr& other) const override {
-            return std::make_unique<Z3Expr>(repr != AsExpr(other));
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Lt(const InternalExpr& other) const override {
-            return std::make_unique<Z3Expr>(repr < AsExpr(other));
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Leq(const InternalExpr& other) const override {
-            return std::make_unique<Z3Expr>(repr <= AsExpr(other));
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Gt(const InternalExpr& other) const override {
-            return std::make_unique<Z3Expr>(repr > AsExpr(other));
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Geq(const InternalExpr& other) const override {
-            return std::make_unique<Z3Expr>(repr >= AsExpr(other));
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Implies(const InternalExpr& other) const override {
-            return std::make_unique<Z3Expr>(z3::implies(repr, AsExpr(other)));
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Contains(const InternalExpr&) const override {
-            throw InternalEncodingError("'z3::expr' does not support 'operator()'");
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Copy() const override {
-            return std::make_unique<Z3Expr>(repr);
-        }
-    };
-    
-    struct Z3FuncDecl : public InternalExpr {
-        z3::func_decl repr;
-        
-        explicit Z3FuncDecl(const z3::func_decl& repr) : repr(repr) {}
-    
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Contains(const InternalExpr& other) const override {
-            return std::make_unique<Z3Expr>(repr(AsExpr(other)));
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Eq(const InternalExpr& otherFuncDecl) const override {
-            auto other = AsFuncDecl(otherFuncDecl);
-            // TODO: is this too much of a hack?
-            assert(repr.arity() == 1);
-            assert(other.arity() == 1);
-            assert(z3::eq(repr.domain(0), other.domain(0)));
-            auto qv = repr.ctx().constant("__op-qv", repr.domain(0));
-            auto expr = z3::forall(qv, repr(qv) == other(qv));
-            return std::make_unique<Z3Expr>(expr);
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Neq(const InternalExpr& other) const override {
-            return this->Eq(other)->Negate();
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Copy() const override {
-            return std::make_unique<Z3FuncDecl>(repr);
-        }
-    
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Negate() const override {
-            throw InternalEncodingError("'z3::func_decl' does not support 'operator!'");
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> And(const InternalExpr&) const override {
-            throw InternalEncodingError("'z3::func_decl' does not support 'operator&&'");
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Or(const InternalExpr&) const override {
-            throw InternalEncodingError("'z3::func_decl' does not support 'operator||'");
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Lt(const InternalExpr&) const override {
-            throw InternalEncodingError("'z3::func_decl' does not support 'operator<'");
-        }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Leq(const InternalExpr&) const override {
-            throw InternalEncodingError("'z3::func_decl' does not support 'operator<='");
+    struct InternalExprAccess {
+        // 'z3::expr' and 'z3::func_decl' add no members to 'z3::ast', both are stored as the latter
+        static_assert(sizeof(z3::ast) <= EExpr::STORAGE_SIZE, "'EExpr' cannot store 'z3::ast' inline");
+        static_assert(alignof(z3::ast) <= alignof(void*), "'EExpr' cannot store 'z3::ast' inline");
+
+        static inline z3::ast& Handle(EExpr& expr) {
+            return *std::launder(reinterpret_cast<z3::ast*>(expr.storage));
         }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Gt(const InternalExpr&) const override {
-            throw InternalEncodingError("'z3::func_decl' does not support 'operator>'");
+        static inline const z3::ast& Handle(const EExpr& expr) {
+            return *std::launder(reinterpret_cast<const z3::ast*>(expr.storage));
         }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Geq(const InternalExpr&) const override {
-            throw InternalEncodingError("'z3::func_decl' does not support 'operator>='");
+        static inline bool IsFuncDecl(const EExpr& expr) {
+            return expr.kind == EExpr::Kind::FUNC_DECL;
         }
-        [[nodiscard]] inline std::unique_ptr<InternalExpr> Implies(const InternalExpr&) const override {
-            throw InternalEncodingError("'z3::func_decl' does not support 'operator>>'");
+        static inline EExpr Make(const z3::ast& handle, bool isFuncDecl) {
+            EExpr result(isFuncDecl ? EExpr::Kind::FUNC_DECL : EExpr::Kind::EXPR);
+            new (result.storage) z3::ast(handle);
+            return result;
         }
     };
-    
-    inline z3::expr AsExpr(const InternalExpr& expr) {
-        if (auto down = dynamic_cast<const Z3Expr*>(&expr)) return down->repr;
-        throw InternalEncodingError("expected 'z3::expr'");
+
+    inline bool IsFuncDecl(const EExpr& expr) {
+        return InternalExprAccess::IsFuncDecl(expr);
     }
     
     inline z3::expr AsExpr(const EExpr& expr) {
-        return AsExpr(expr.Repr());
+        if (IsFuncDecl(expr)) throw InternalEncodingError("expected 'z3::expr'");
+        const auto& handle = InternalExprAccess::Handle(expr);
+        return z3::expr(handle.ctx(), handle);
     }
     
-    inline z3::func_decl AsFuncDecl(const InternalExpr& expr) {
-        if (auto down = dynamic_cast<const Z3FuncDecl*>(&expr)) return down->repr;
-        throw InternalEncodingError("expected 'z3::func_decl'");
+    inline z3::func_decl AsFuncDecl(const EExpr& expr) {
+        if (!IsFuncDecl(expr)) throw InternalEncodingError("expected 'z3::func_decl'");
+        const auto& handle = InternalExprAccess::Handle(expr);
+        return z3::func_decl(handle.ctx(), Z3_to_func_decl(handle.ctx(), handle));
     }
     
-    inline z3::func_decl AsFuncDecl(const EExpr& expr) {
-        return AsFuncDecl(expr.Repr());
+    const EngineSetup& GetEncodingSetup();
+
+    bool IsRecordingQueries();
+    void RecordQuery(CorpusEntry::Kind kind, const std::string& category, z3::solver& solver,
+                     const std::deque<EExpr>& checks, const std::vector<bool>& results, std::chrono::microseconds time);
+
+    inline bool HasBudget(const EngineSetup& setup) {
+        return setup.smtTimeout > 0 || setup.smtResourceLimit > 0;
+    }
+
+    inline z3::params MakeBudget(z3::context& context, std::size_t scale = 1) {
+        const auto& setup = GetEncodingSetup();
+        auto scaled = [scale](unsigned int value) -> unsigned int {
+            if (value == 0) return 0;
+            return (unsigned int) std::min<std::size_t>(value * scale, std::numeric_limits<unsigned int>::max());
+        };
+        z3::params result(context);
+        auto timeout = scaled(setup.smtTimeout);
+        result.set("timeout", timeout == 0 ? std::numeric_limits<unsigned int>::max() : timeout);
+        result.set("rlimit", scaled(setup.smtResourceLimit));
+        return result;
+    }
+
+    inline void SetBudget(z3::solver& solver, std::size_t scale = 1) {
+        // only touch the solver's parameters if budgets are in use
+        if (!HasBudget(GetEncodingSetup())) return;
+        solver.set(MakeBudget(solver.ctx(), scale));
+    }
+
+    // sets the parameters of 'category' and of all categories, see 'EngineSetup::smtParamsByCategory'
+    void ApplySmtParams(z3::solver& solver, const std::string& category);
+
+    /**
+     * Selectors are fresh boolean constants guarding a single check, i.e., 'selector => check' is asserted and the
+     * check is solved under the assumption 'selector'. Afterwards, '!selector' is asserted to retire the guard.
+     */
+    static constexpr const char* SELECTOR_PREFIX = "__sel";
+
+    inline z3::expr MakeSelector(z3::context& context) {
+        return z3::to_expr(context, Z3_mk_fresh_const(context, SELECTOR_PREFIX, context.bool_sort()));
+    }
+
+    inline bool IsSelector(const z3::expr& expr) {
+        if (!expr.is_const() || !expr.is_bool()) return false;
+        return expr.decl().name().str().rfind(SELECTOR_PREFIX, 0) == 0;
+    }
+
+    inline bool IsSelectorAssertion(const z3::expr& expr) {
+        if (!expr.is_not() && !expr.is_implies()) return false;
+        return IsSelector(expr.arg(0));
+    }
+
+    inline z3::expr MakePremise(z3::solver& solver) {
+        // selector guards are irrelevant for the premise, dropping them keeps the premise stable across queries
+        z3::expr_vector result(solver.ctx());
+        for (const auto& assertion : solver.assertions()) {
+            if (IsSelectorAssertion(assertion)) continue;
+            result.push_back(assertion);
+        }
+        return z3::mk_and(result);
+    }
+
+    inline z3::expr Translate(const z3::expr& expr, const z3::context& srcContext, z3::context& dstContext) {
+        return z3::to_expr(dstContext, Z3_translate(srcContext, expr, dstContext));
     }
     
     struct Z3InternalStorage : public InternalStorage {
         z3::context context;
         z3::solver solver;
+        z3::expr poolPremise; // premise last handed to the worker pool
+        std::size_t poolTicket; // identifies 'poolPremise' among worker pool jobs, 0 if unset
+        bool hasBackground = false; // background axioms are asserted below the solver's first scope
+        std::string category; // category of the queries, selects the solver parameters, see 'ApplySmtParams'
+        std::unique_ptr<StackPresolver> presolver; // stack part of the most recent premise, see 'EngineSetup::smtPresolve'
+        z3::expr_vector presolverAssertions; // solver assertions 'presolver' was last checked against, see 'GetPresolver'
+        std::map<std::tuple<const SolverConfig*, const void*, bool>, std::pair<EExpr, std::vector<EExpr>>> invariants; // templates with their placeholders, see 'Encoding::EncodeInvariant'; keyed by address, configs and types must outlive the pool
     
-        explicit Z3InternalStorage() : context(), solver(context) {}
+        explicit Z3InternalStorage() : context(), solver(context), poolPremise(context), poolTicket(0), presolverAssertions(context) {
+            SetBudget(solver);
+        }
         
 //        inline z3::expr_vector AsVector(const std::vector<EExpr>& vector) {
 //            z3::expr_vector result(context);
-//            for (const auto& elem : vector) result.push_back(AsExpr(elem.Repr()));
+//            for (const auto& elem : vector) result.push_back(AsExpr(elem));
 //            return result;
 //        }
     };
@@ -155,23 +157,11 @@ namespace plankton {
     }
     
     inline EExpr AsEExpr(const z3::expr& expr) {
-        return EExpr(std::make_unique<Z3Expr>(expr));
+        return InternalExprAccess::Make(expr, false);
     }
     
     inline EExpr AsEExpr(const z3::func_decl& expr) {
-        return EExpr(std::make_unique<Z3FuncDecl>(expr));
-    }
-    
-    inline EExpr AsEExpr(const InternalExpr& expr) {
-        return EExpr(expr.Copy());
-    }
-    
-    inline EExpr AsEExpr(const std::unique_ptr<InternalExpr>& expr) {
-        return EExpr(expr->Copy());
-    }
-    
-    inline EExpr AsEExpr(std::unique_ptr<InternalExpr>&& expr) {
-        return EExpr(std::move(expr));
+        return InternalExprAccess::Make(expr, true);
     }
 
 } // namespace plankton
@@ -0,0 +1,137 @@
+#include "engine/encoding.hpp"
+
+#include "internal.hpp"
+#include "logics/util.hpp"
+
+using namespace plankton;
+
+#define CTX AsContext(internal)
+
+
+//
+// Substitution
+//
+
+struct Substitution {
+    z3::expr_vector replaceExprs, withExprs;
+    std::map<unsigned, z3::func_decl> funcs; // flows are functions, unless 'EngineSetup::smtFiniteDomain' is set
+    std::map<unsigned, z3::expr> memo;
+
+    explicit Substitution(z3::context& context) : replaceExprs(context), withExprs(context) {}
+
+    void Add(const EExpr& replace, const EExpr& with) {
+        if (IsFuncDecl(replace)) {
+            funcs.emplace(AsFuncDecl(replace).id(), AsFuncDecl(with));
+        } else {
+            replaceExprs.push_back(AsExpr(replace));
+            withExprs.push_back(AsExpr(with));
+        }
+    }
+
+    z3::expr Apply(const z3::expr& expr) {
+        // 'z3::expr::substitute' cannot replace function symbols, rewrite their applications manually
+        if (funcs.empty()) return z3::expr(expr).substitute(replaceExprs, withExprs);
+        return Rewrite(expr).substitute(replaceExprs, withExprs);
+    }
+
+    z3::expr Rewrite(const z3::expr& expr) {
+        if (!expr.is_app() && !expr.is_quantifier()) return expr;
+        auto find = memo.find(expr.id());
+        if (find != memo.end()) return find->second;
+
+        auto& context = expr.ctx();
+        z3::expr result = expr;
+        if (expr.is_quantifier()) {
+            auto body = Rewrite(expr.body());
+            Z3_ast arg = body;
+            result = z3::to_expr(context, Z3_update_term(context, expr, 1, &arg));
+        } else {
+            std::vector<Z3_ast> args;
+            z3::expr_vector keepAlive(context);
+            for (unsigned index = 0; index < expr.num_args(); ++index) {
+                keepAlive.push_back(Rewrite(expr.arg(index)));
+                args.push_back(keepAlive.back());
+            }
+            auto func = funcs.find(expr.decl().id());
+            if (func != funcs.end()) result = func->second(keepAlive);
+            else if (!args.empty()) result = z3::to_expr(context, Z3_update_term(context, expr, args.size(), args.data()));
+        }
+        memo.emplace(expr.id(), result);
+        return result;
+    }
+};
+
+
+//
+// Templates
+//
+
+/**
+ * Invariants are instantiated and encoded once per node type (resp. shared variable) for placeholder symbols.
+ * Concrete instances are obtained by substituting the encodings of the actual symbols for the placeholders,
+ * which avoids building, copying, and encoding an invariant AST for every single memory axiom.
+ */
+
+inline std::vector<const SymbolDeclaration*> GetSymbols(const MemoryAxiom& memory) {
+    std::vector<const SymbolDeclaration*> result;
+    result.reserve(memory.fieldToValue.size() + 2);
+    result.push_back(&memory.node->Decl());
+    result.push_back(&memory.flow->Decl());
+    for (const auto& pair : memory.fieldToValue) result.push_back(&pair.second->Decl());
+    return result;
+}
+
+inline std::unique_ptr<MemoryAxiom> MakePlaceholder(const MemoryAxiom& memory) {
+    SymbolFactory factory;
+    auto& node = factory.GetFreshFO(memory.node->GetType());
+    auto& flow = factory.GetFreshSO(memory.flow->GetType());
+    std::map<std::string, std::reference_wrapper<const SymbolDeclaration>> fields;
+    for (const auto& [name, value] : memory.fieldToValue) {
+        fields.emplace(name, factory.GetFresh(value->GetType(), value->GetOrder()));
+    }
+    if (plankton::IsLocal(memory)) return std::make_unique<LocalMemoryResource>(node, flow, fields);
+    return std::make_unique<SharedMemoryCore>(node, flow, fields);
+}
+
+inline std::unique_ptr<ImplicationSet> MakeInvariant(const MemoryAxiom& memory, const SolverConfig& config) {
+    if (auto local = dynamic_cast<const LocalMemoryResource*>(&memory)) return config.GetLocalNodeInvariant(*local);
+    if (auto shared = dynamic_cast<const SharedMemoryCore*>(&memory)) return config.GetSharedNodeInvariant(*shared);
+    throw std::logic_error("Internal error: cannot produce invariant for node."); // TODO: better error handling
+}
+
+EExpr Encoding::EncodeInvariant(const MemoryAxiom& memory, const SolverConfig& config) {
+    // templates are kept with the context, which is pooled, so that they are reused across short-lived encodings
+    auto& invariantEncoding = AsInternal(internal).invariants;
+    auto key = std::make_tuple(&config, (const void*) &memory.node->GetType(), plankton::IsLocal(memory));
+    auto find = invariantEncoding.find(key);
+    if (find == invariantEncoding.end()) {
+        auto placeholder = MakePlaceholder(memory);
+        auto invariant = Encode(*MakeInvariant(*placeholder, config));
+        std::vector<EExpr> symbols;
+        for (const auto* decl : GetSymbols(*placeholder)) symbols.push_back(Encode(*decl));
+        find = invariantEncoding.emplace(key, std::make_pair(invariant, std::move(symbols))).first;
+    }
+
+    const auto& [invariant, placeholders] = find->second;
+    auto symbols = GetSymbols(memory);
+    if (symbols.size() != placeholders.size()) return Encode(*MakeInvariant(memory, config));
+    Substitution substitution(CTX);
+    for (std::size_t index = 0; index < symbols.size(); ++index) {
+        substitution.Add(placeholders.at(index), Encode(*symbols.at(index)));
+    }
+    return AsEExpr(substitution.Apply(AsExpr(invariant)));
+}
+
+EExpr Encoding::EncodeInvariant(const EqualsToAxiom& variable, const SolverConfig& config) {
+    auto& invariantEncoding = AsInternal(internal).invariants;
+    auto key = std::make_tuple(&config, (const void*) &variable.Variable(), false);
+    auto find = invariantEncoding.find(key);
+    if (find == invariantEncoding.end()) {
+        auto& value = SymbolFactory().GetFreshFO(variable.Value().type);
+        auto invariant = Encode(*config.GetSharedVariableInvariant(EqualsToAxiom(variable.Variable(), value)));
+        find = invariantEncoding.emplace(key, std::make_pair(invariant, std::vector<EExpr>{ Encode(value) })).first;
+    }
+
+    const auto& [invariant, placeholders] = find->second;
+    return Replace(invariant, placeholders.front(), Encode(variable.Value()));
+}
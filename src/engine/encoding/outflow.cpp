@@ -0,0 +1,81 @@
+#include "outflow.hpp"
+
+#include "logics/util.hpp"
+#include "util/shortcuts.hpp"
+
+using namespace plankton;
+
+
+inline bool Mentions(const LogicObject& object, const SymbolDeclaration& decl) {
+    auto occurrences = plankton::Collect<SymbolicVariable>(object, [&decl](const auto& var){
+        return &var.Decl() == &decl;
+    });
+    return !occurrences.empty();
+}
+
+inline bool IsKey(const SymbolicExpression& expr, const SymbolDeclaration& key) {
+    auto var = dynamic_cast<const SymbolicVariable*>(&expr);
+    return var && &var->Decl() == &key;
+}
+
+inline EExpr Compare(const EExpr& lhs, BinaryOperator op, const EExpr& rhs) {
+    switch (op) {
+        case BinaryOperator::EQ: return lhs == rhs;
+        case BinaryOperator::NEQ: return lhs != rhs;
+        case BinaryOperator::LEQ: return lhs <= rhs;
+        case BinaryOperator::LT: return lhs < rhs;
+        case BinaryOperator::GEQ: return lhs >= rhs;
+        case BinaryOperator::GT: return lhs > rhs;
+    }
+    throw std::logic_error("Internal error: unknown binary operator."); // TODO: better error handling
+}
+
+OutflowPredicate::OutflowPredicate(Encoding& encoding, const MemoryAxiom& memory, const std::string& field,
+                                   const SolverConfig& config) : encoding(encoding) {
+    auto& key = SymbolFactory(memory).GetFreshFO(config.GetFlowValueType());
+    auto outflow = config.GetOutflowContains(memory, field, key);
+
+    // try to split the predicate into key-free conditions and (guarded) bounds on the key
+    Interval result;
+    auto isInterval = [&]() {
+        for (const auto& implication : outflow->conjuncts) {
+            if (Mentions(*implication->premise, key)) return false;
+            auto guard = encoding.Encode(*implication->premise);
+            for (const auto& conjunct : implication->conclusion->conjuncts) {
+                if (!Mentions(*conjunct, key)) {
+                    result.conditions.push_back(guard >> encoding.Encode(*conjunct));
+                    continue;
+                }
+                auto axiom = dynamic_cast<const StackAxiom*>(conjunct.get());
+                if (!axiom || axiom->op == BinaryOperator::NEQ) return false;
+                if (IsKey(*axiom->lhs, key) && !Mentions(*axiom->rhs, key)) {
+                    result.bounds.push_back({ guard, axiom->op, encoding.Encode(*axiom->rhs) });
+                } else if (IsKey(*axiom->rhs, key) && !Mentions(*axiom->lhs, key)) {
+                    result.bounds.push_back({ guard, Symmetric(axiom->op), encoding.Encode(*axiom->lhs) });
+                } else {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    if (isInterval()) {
+        interval = std::move(result);
+    } else {
+        predicate = encoding.Encode(*outflow);
+        dummy = encoding.Encode(key);
+    }
+}
+
+bool OutflowPredicate::IsInterval() const {
+    return interval.has_value();
+}
+
+EExpr OutflowPredicate::Contains(const EExpr& value) {
+    if (!interval) return encoding.Replace(predicate.value(), dummy.value(), value);
+    auto result = plankton::MakeVector<EExpr>(interval->conditions.size() + interval->bounds.size());
+    for (const auto& condition : interval->conditions) result.push_back(condition);
+    for (const auto& bound : interval->bounds) result.push_back(bound.guard >> Compare(value, bound.op, bound.value));
+    return encoding.MakeAnd(result);
+}
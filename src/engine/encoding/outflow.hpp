@@ -0,0 +1,45 @@
+#pragma once
+#ifndef PLANKTON_ENGINE_OUTFLOW_HPP
+#define PLANKTON_ENGINE_OUTFLOW_HPP
+
+#include <optional>
+#include "engine/encoding.hpp"
+#include "engine/config.hpp"
+
+namespace plankton {
+
+    /**
+     * The outflow predicate of a memory's field, instantiated once and applied to arbitrary values.
+     *
+     * Predicates that constrain the key only by comparisons with key-free terms, like 'node->val < key', are
+     * intervals: the key must lie between the largest and the smallest (guarded) bound. Those are encoded as
+     * plain comparisons with the bounds. All other predicates fall back to substituting the value for a dummy.
+     * Flows themselves remain sets: the frame inflow is unconstrained, an interval would not cover it.
+     */
+    struct OutflowPredicate final {
+        explicit OutflowPredicate(Encoding& encoding, const MemoryAxiom& memory, const std::string& field,
+                                  const SolverConfig& config);
+
+        [[nodiscard]] bool IsInterval() const;
+        EExpr Contains(const EExpr& value);
+
+        private:
+            struct Bound {
+                EExpr guard;
+                BinaryOperator op; // 'key op value'
+                EExpr value;
+            };
+            struct Interval {
+                std::vector<EExpr> conditions; // key-free parts of the predicate
+                std::vector<Bound> bounds;
+            };
+
+            Encoding& encoding;
+            std::optional<Interval> interval;
+            std::optional<EExpr> predicate;
+            std::optional<EExpr> dummy;
+    };
+
+} // namespace plankton
+
+#endif //PLANKTON_ENGINE_OUTFLOW_HPP
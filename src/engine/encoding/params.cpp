@@ -0,0 +1,135 @@
+#include "engine/params.hpp"
+
+#include <sstream>
+#include "internal.hpp"
+
+using namespace plankton;
+
+static constexpr const char* MODULE_PREFIX = "smt."; // solvers accept 'smt' parameters without their module name
+
+
+struct BadSmtParams : std::logic_error {
+    explicit BadSmtParams(const std::string& reason) : std::logic_error("Bad SMT parameters: " + reason + ".") {}
+};
+
+inline const std::map<std::string, Z3_param_kind>& GetParamKinds() {
+    // the kinds do not depend on the context, look them up once
+    static const auto kinds = [](){
+        z3::context context;
+        z3::solver solver(context);
+        auto descriptions = solver.get_param_descrs();
+        std::map<std::string, Z3_param_kind> result;
+        for (unsigned index = 0; index < descriptions.size(); ++index) {
+            auto name = descriptions.name(index);
+            result.emplace(name.str(), descriptions.kind(name));
+        }
+        return result;
+    }();
+    return kinds;
+}
+
+inline std::pair<std::string, Z3_param_kind> GetParam(const std::string& name) {
+    const auto& kinds = GetParamKinds();
+    auto find = kinds.find(name);
+    if (find == kinds.end() && name.rfind(MODULE_PREFIX, 0) == 0) {
+        find = kinds.find(name.substr(std::string(MODULE_PREFIX).size()));
+    }
+    if (find == kinds.end()) throw BadSmtParams("unknown parameter '" + name + "'");
+    return *find;
+}
+
+inline unsigned int ParseUnsigned(const std::string& name, const std::string& value) {
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+        throw BadSmtParams("expected unsigned integer for '" + name + "', got '" + value + "'");
+    }
+    try {
+        auto result = std::stoul(value);
+        if (result > std::numeric_limits<unsigned int>::max()) throw std::out_of_range(value);
+        return (unsigned int) result;
+    } catch (const std::out_of_range&) {
+        throw BadSmtParams("value '" + value + "' for '" + name + "' is out of range");
+    }
+}
+
+inline bool ParseBool(const std::string& name, const std::string& value) {
+    if (value == "true") return true;
+    if (value == "false") return false;
+    throw BadSmtParams("expected 'true' or 'false' for '" + name + "', got '" + value + "'");
+}
+
+inline double ParseDouble(const std::string& name, const std::string& value) {
+    std::size_t end = 0;
+    double result;
+    try {
+        result = std::stod(value, &end);
+    } catch (const std::logic_error&) {
+        end = 0;
+    }
+    if (end == 0 || end != value.size()) throw BadSmtParams("expected number for '" + name + "', got '" + value + "'");
+    return result;
+}
+
+inline void SetParam(z3::params& params, const std::string& name, const std::string& value) {
+    auto [key, kind] = GetParam(name);
+    switch (kind) {
+        case Z3_PK_UINT: params.set(key.c_str(), ParseUnsigned(name, value)); return;
+        case Z3_PK_BOOL: params.set(key.c_str(), ParseBool(name, value)); return;
+        case Z3_PK_DOUBLE: params.set(key.c_str(), ParseDouble(name, value)); return;
+        case Z3_PK_SYMBOL: case Z3_PK_STRING: params.set(key.c_str(), value.c_str()); return;
+        default: throw BadSmtParams("unsupported parameter '" + name + "'");
+    }
+}
+
+
+//
+// Files
+//
+
+void plankton::CheckSmtParams(const SmtParams& params) {
+    z3::context context;
+    z3::params dummy(context);
+    for (const auto& [name, value] : params) SetParam(dummy, name, value);
+}
+
+SmtParamsByCategory plankton::ReadSmtParams(std::istream& stream) {
+    SmtParamsByCategory result;
+    std::string line;
+    while (std::getline(stream, line)) {
+        std::stringstream tokens(line);
+        std::string category, name, value, rest;
+        if (!(tokens >> category) || category.front() == '#') continue;
+        if (!(tokens >> name >> value) || (tokens >> rest)) throw BadSmtParams("expected 'category name value', got '" + line + "'");
+        result[category][name] = value;
+    }
+    for (const auto& [category, params] : result) CheckSmtParams(params);
+    return result;
+}
+
+void plankton::WriteSmtParams(std::ostream& stream, const SmtParamsByCategory& params) {
+    for (const auto& [category, categoryParams] : params) {
+        for (const auto& [name, value] : categoryParams) stream << category << " " << name << " " << value << std::endl;
+    }
+}
+
+
+//
+// Solvers
+//
+
+void plankton::ApplySmtParams(z3::solver& solver, const std::string& category) {
+    const auto& byCategory = GetEncodingSetup().smtParamsByCategory;
+    if (byCategory.empty()) return;
+
+    // specific parameters are set last and thus take precedence
+    z3::params params(solver.ctx());
+    bool empty = true;
+    auto add = [&](const std::string& key) {
+        auto find = byCategory.find(key);
+        if (find == byCategory.end()) return;
+        for (const auto& [name, value] : find->second) SetParam(params, name, value);
+        empty &= find->second.empty();
+    };
+    add(SMT_PARAMS_ALL_CATEGORIES);
+    if (category != SMT_PARAMS_ALL_CATEGORIES) add(category);
+    if (!empty) solver.set(params);
+}
@@ -0,0 +1,197 @@
+#include "pool.hpp"
+
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include "util/shortcuts.hpp"
+
+using namespace plankton;
+
+static constexpr std::size_t FALLBACK_THREAD_COUNT = 8;
+
+
+inline std::size_t MakeTicket() {
+    static std::atomic<std::size_t> counter = 0;
+    return ++counter;
+}
+
+inline std::size_t GetThreadCount(const EngineSetup& setup) {
+    if (setup.smtWorkerCount > 0) return setup.smtWorkerCount;
+    auto result = std::thread::hardware_concurrency();
+    if (result > 0) return result * 2;
+    return FALLBACK_THREAD_COUNT;
+}
+
+
+//
+// Jobs
+//
+
+struct WorkerPool::Job {
+    // owned by the caller, must only be accessed while holding 'mutex'
+    z3::context& srcContext;
+    const z3::expr& premise;
+    const std::deque<EExpr>& expressions;
+
+    const std::string category; // copied, workers inspect it after the caller returned
+    const std::size_t ticket;
+    const ImplicationCheck& isImplied;
+    std::vector<std::size_t> order;
+    std::size_t next = 0;
+    std::size_t pending;
+    std::vector<char> result;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable done;
+
+    explicit Job(z3::context& context, const z3::expr& premise, const std::string& category, std::size_t ticket,
+                 const std::deque<EExpr>& expressions, const ImplicationCheck& isImplied)
+            : srcContext(context), premise(premise), expressions(expressions), category(category), ticket(ticket),
+              isImplied(isImplied),
+              pending(expressions.size()), result(expressions.size(), false) {
+        order.reserve(expressions.size());
+        for (std::size_t index = 0; index < expressions.size(); ++index) order.push_back(index);
+        std::shuffle(order.begin(), order.end(), std::default_random_engine());
+    }
+
+    [[nodiscard]] inline bool Exhausted() const {
+        return next >= order.size();
+    }
+
+    inline void Abort(std::exception_ptr exception) {
+        if (!error) error = std::move(exception);
+        pending -= order.size() - next;
+        next = order.size();
+    }
+};
+
+struct Task {
+    std::size_t id;
+    z3::expr expr;
+    explicit Task(std::size_t id, const z3::expr& expr) : id(id), expr(expr) {}
+};
+
+
+//
+// Pool
+//
+
+WorkerPool& WorkerPool::Get() {
+    // never destroyed: workers block on 'wakeup' until the process exits
+    static auto* pool = new WorkerPool(GetThreadCount(GetEncodingSetup()), GetEncodingSetup().smtBatchSize);
+    return *pool;
+}
+
+WorkerPool::WorkerPool(std::size_t workerCount, std::size_t batchSize_) : batchSize(std::max<std::size_t>(batchSize_, 1)) {
+    workers.reserve(workerCount);
+    for (std::size_t index = 0; index < workerCount; ++index) {
+        workers.emplace_back([this](){ Work(); });
+    }
+}
+
+std::size_t WorkerPool::GetWorkerCount() const {
+    return workers.size();
+}
+
+std::size_t WorkerPool::GetBatchSize() const {
+    return batchSize;
+}
+
+void WorkerPool::Retire(const std::shared_ptr<Job>& job) {
+    std::lock_guard guard(mutex);
+    plankton::RemoveIf(jobs, [&job](const auto& elem){ return elem == job; });
+}
+
+void WorkerPool::Work() {
+    z3::context context;
+    z3::solver solver(context);
+    std::size_t loadedTicket = 0;
+    std::string loadedCategory;
+    SetBudget(solver);
+
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock guard(mutex);
+            wakeup.wait(guard, [this](){ return !jobs.empty(); });
+            job = jobs.front();
+        }
+
+        // take tasks, translation requires exclusive access to the source context
+        std::vector<Task> tasks;
+        bool exhausted;
+        {
+            std::lock_guard guard(job->mutex);
+            try {
+                auto paramsInUse = !GetEncodingSetup().smtParamsByCategory.empty();
+                if (!job->Exhausted() && (loadedTicket != job->ticket || (paramsInUse && loadedCategory != job->category))) {
+                    // resetting a solver keeps its parameters, start over with a fresh one
+                    loadedTicket = 0;
+                    solver = z3::solver(context);
+                    SetBudget(solver);
+                    ApplySmtParams(solver, job->category);
+                    loadedCategory = job->category;
+                    solver.add(Translate(job->premise, job->srcContext, context));
+                    loadedTicket = job->ticket;
+                }
+                tasks.reserve(batchSize);
+                for (std::size_t count = 0; count < batchSize && !job->Exhausted(); ++count) {
+                    auto id = job->order.at(job->next++);
+                    tasks.emplace_back(id, Translate(AsExpr(job->expressions.at(id)), job->srcContext, context));
+                }
+            } catch (...) {
+                job->pending -= tasks.size();
+                tasks.clear();
+                job->Abort(std::current_exception());
+                if (job->pending == 0) job->done.notify_all();
+            }
+            exhausted = job->Exhausted();
+        }
+        if (exhausted) Retire(job);
+        if (tasks.empty()) continue;
+
+        // solve
+        std::vector<std::pair<std::size_t, bool>> results;
+        results.reserve(tasks.size());
+        std::exception_ptr error;
+        try {
+            for (const auto& task : tasks) {
+                results.emplace_back(task.id, job->isImplied(solver, task.expr));
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        // report
+        std::lock_guard guard(job->mutex);
+        for (const auto& [id, implied] : results) job->result.at(id) = implied;
+        job->pending -= tasks.size();
+        if (error) job->Abort(error);
+        if (job->pending == 0) job->done.notify_all();
+    }
+}
+
+std::vector<bool> WorkerPool::ComputeImplied(Z3InternalStorage& storage, z3::solver& solver,
+                                             const std::deque<EExpr>& expressions, const ImplicationCheck& isImplied) {
+    if (expressions.empty()) return {};
+
+    // identify premise, workers keep it loaded across jobs with the same ticket
+    auto premise = MakePremise(solver);
+    if (storage.poolTicket == 0 || !z3::eq(premise, storage.poolPremise)) {
+        storage.poolPremise = premise;
+        storage.poolTicket = MakeTicket();
+    }
+
+    auto job = std::make_shared<Job>(storage.context, storage.poolPremise, storage.category, storage.poolTicket,
+                                     expressions, isImplied);
+    {
+        std::lock_guard guard(mutex);
+        jobs.push_back(job);
+    }
+    wakeup.notify_all();
+
+    std::unique_lock guard(job->mutex);
+    job->done.wait(guard, [&job](){ return job->pending == 0; });
+    if (job->error) std::rethrow_exception(job->error);
+    return std::vector<bool>(job->result.begin(), job->result.end());
+}
@@ -0,0 +1,52 @@
+#pragma once
+#ifndef PLANKTON_ENGINE_POOL_HPP
+#define PLANKTON_ENGINE_POOL_HPP
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include "internal.hpp"
+
+namespace plankton {
+
+    using ImplicationCheck = std::function<bool(z3::solver&, const z3::expr&)>;
+
+    /**
+     * Process-wide pool of solver threads. Each worker owns a long-lived 'z3::context' and keeps the premise
+     * of the most recent job loaded, so consecutive batches over the same premise are not re-translated.
+     */
+    struct WorkerPool final {
+        static WorkerPool& Get();
+
+        WorkerPool(const WorkerPool& other) = delete;
+        WorkerPool& operator=(const WorkerPool& other) = delete;
+
+        [[nodiscard]] std::size_t GetWorkerCount() const;
+        [[nodiscard]] std::size_t GetBatchSize() const;
+
+        /**
+         * Computes which of the given expressions are implied by the assertions of 'solver', which must live in
+         * the storage's context; the storage remembers the premise's ticket. Blocks until all expressions are
+         * checked; 'isImplied' is invoked on the workers' solvers.
+         */
+        std::vector<bool> ComputeImplied(Z3InternalStorage& storage, z3::solver& solver,
+                                         const std::deque<EExpr>& expressions, const ImplicationCheck& isImplied);
+
+        private:
+            struct Job;
+            std::size_t batchSize;
+            std::mutex mutex;
+            std::condition_variable wakeup;
+            std::deque<std::shared_ptr<Job>> jobs;
+            std::vector<std::thread> workers;
+
+            explicit WorkerPool(std::size_t workerCount, std::size_t batchSize);
+            void Work();
+            void Retire(const std::shared_ptr<Job>& job);
+    };
+
+} // namespace plankton
+
+#endif //PLANKTON_ENGINE_POOL_HPP
@@ -0,0 +1,131 @@
+#include "portfolio.hpp"
+
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <exception>
+#include "util/log.hpp"
+#include "util/shortcuts.hpp"
+
+using namespace plankton;
+
+
+struct Configuration {
+    unsigned int seed;
+    bool mbqi;
+    bool tactic;
+};
+
+static const std::vector<Configuration> CONFIGURATIONS = {
+        { 1, true, false },
+        { 2, false, false },
+        { 3, true, true },
+        { 4, false, true },
+};
+
+static constexpr unsigned int FALLBACK_TIMEOUT = 10000; // milliseconds, for runs without a configured budget
+static constexpr std::chrono::milliseconds INTERRUPT_INTERVAL(5);
+
+struct Run {
+    z3::context context;
+    z3::expr formula;
+    bool running = false; // guarded by the race's mutex
+
+    explicit Run(const z3::expr& srcFormula) : context(), formula(Translate(srcFormula, srcFormula.ctx(), context)) {}
+
+    inline z3::solver MakeSolver(const Configuration& config) {
+        auto solver = config.tactic ? MakeTacticSolver() : z3::solver(context);
+        if (HasBudget(GetEncodingSetup())) {
+            SetBudget(solver, GetEncodingSetup().smtBudgetEscalation);
+        } else {
+            // runs that lose the race are interrupted, but a run left alone must not hang the verification
+            z3::params budget(context);
+            budget.set("timeout", FALLBACK_TIMEOUT);
+            solver.set(budget);
+        }
+        z3::params params(context);
+        params.set("random_seed", config.seed);
+        params.set("mbqi", config.mbqi);
+        solver.set(params);
+        solver.add(formula);
+        return solver;
+    }
+
+    private:
+        inline z3::solver MakeTacticSolver() {
+            auto tactic = z3::tactic(context, "simplify") & z3::tactic(context, "propagate-values")
+                          & z3::tactic(context, "solve-eqs") & z3::tactic(context, "smt");
+            return tactic.mk_solver();
+        }
+};
+
+struct Race {
+    std::vector<std::unique_ptr<Run>> runs;
+    std::mutex mutex;
+    z3::check_result result = z3::unknown;
+
+    explicit Race(const z3::expr& formula) {
+        // translate on the calling thread, the source context must not be shared
+        runs.reserve(CONFIGURATIONS.size());
+        for (std::size_t index = 0; index < CONFIGURATIONS.size(); ++index) runs.push_back(std::make_unique<Run>(formula));
+    }
+
+    inline void Participate(std::size_t index) {
+        auto& run = *runs.at(index);
+        auto solver = run.MakeSolver(CONFIGURATIONS.at(index));
+        {
+            // an interrupt is lost if it arrives before 'check' started, see 'InterruptLosers'
+            std::lock_guard guard(mutex);
+            if (result != z3::unknown) return;
+            run.running = true;
+        }
+        z3::check_result res;
+        try {
+            res = solver.check();
+        } catch (const z3::exception& err) {
+            res = z3::unknown; // interrupted or failed
+        }
+
+        std::unique_lock guard(mutex);
+        run.running = false;
+        if (res == z3::unknown || result != z3::unknown) return;
+        result = res;
+        InterruptLosers(guard);
+    }
+
+    private:
+        inline void InterruptLosers(std::unique_lock<std::mutex>& guard) {
+            // keep interrupting until all runs stopped, a run may not have entered 'check' at the first attempt
+            while (plankton::Any(runs, [](const auto& run){ return run->running; })) {
+                for (auto& run : runs) if (run->running) run->context.interrupt();
+                guard.unlock();
+                std::this_thread::sleep_for(INTERRUPT_INTERVAL);
+                guard.lock();
+            }
+        }
+};
+
+z3::check_result plankton::SolveWithPortfolio(z3::solver& solver, const z3::expr& query) {
+    Race race(MakePremise(solver) && query);
+    // runs get threads of their own: the 'ThreadPool' is mostly busy with the proof, on it the calling thread would
+    // make most runs one after another (see 'ParallelFor'), each taking up to its full budget
+    std::vector<std::exception_ptr> errors(race.runs.size());
+    std::vector<std::thread> threads;
+    threads.reserve(race.runs.size());
+    for (std::size_t index = 0; index < race.runs.size(); ++index) {
+        threads.emplace_back([&race, &errors, index]() {
+            try {
+                race.Participate(index);
+            } catch (...) {
+                errors.at(index) = std::current_exception();
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+
+    if (race.result == z3::unknown) WARNING("solver portfolio failed to decide a query." << std::endl)
+    return race.result;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#ifndef PLANKTON_ENGINE_PORTFOLIO_HPP
+#define PLANKTON_ENGINE_PORTFOLIO_HPP
+
+#include "internal.hpp"
+
+namespace plankton {
+
+    /**
+     * Decides the satisfiability of the solver's assertions together with 'query' by racing several solver
+     * configurations (random seeds, MBQI on/off, tactic pipelines), each on a thread of its own. Each run owns its
+     * 'z3::context'; the first definite answer wins and interrupts the remaining runs. Returns 'z3::unknown'
+     * if no run succeeds. Intended for queries the solver failed on, i.e., after 'check()' returned 'unknown'.
+     */
+    z3::check_result SolveWithPortfolio(z3::solver& solver, const z3::expr& query);
+
+} // namespace plankton
+
+#endif //PLANKTON_ENGINE_PORTFOLIO_HPP
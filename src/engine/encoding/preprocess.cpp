@@ -0,0 +1,124 @@
+#include "preprocess.hpp"
+
+#include <map>
+#include <optional>
+#include <sstream>
+
+using namespace plankton;
+
+
+inline bool IsValue(const z3::expr& expr) {
+    return expr.is_numeral() || expr.is_true() || expr.is_false();
+}
+
+inline bool IsConstant(const z3::expr& expr) {
+    return expr.is_const() && expr.decl().decl_kind() == Z3_OP_UNINTERPRETED;
+}
+
+inline void Flatten(const z3::expr& expr, std::vector<z3::expr>& result) {
+    if (expr.is_and()) {
+        for (unsigned index = 0; index < expr.num_args(); ++index) Flatten(expr.arg(index), result);
+    } else if (!expr.is_true()) {
+        result.push_back(expr);
+    }
+}
+
+struct AliasClasses {
+    std::map<unsigned, unsigned> parent;
+    std::map<unsigned, z3::expr> members;
+
+    unsigned Find(unsigned id) {
+        auto& next = parent.at(id);
+        if (next != id) next = Find(next);
+        return next;
+    }
+
+    void Add(const z3::expr& expr) {
+        if (members.count(expr.id()) != 0) return;
+        members.emplace(expr.id(), expr);
+        parent.emplace(expr.id(), expr.id());
+    }
+
+    [[nodiscard]] bool IsBetterRepresentative(unsigned id, unsigned other) const {
+        // values are preferred, otherwise the oldest constant for the sake of determinism
+        auto isValue = IsValue(members.at(id));
+        auto otherIsValue = IsValue(members.at(other));
+        if (isValue != otherIsValue) return isValue;
+        return id < other;
+    }
+
+    void Union(const z3::expr& lhs, const z3::expr& rhs) {
+        Add(lhs);
+        Add(rhs);
+        auto lhsRoot = Find(lhs.id());
+        auto rhsRoot = Find(rhs.id());
+        if (lhsRoot == rhsRoot) return;
+        if (IsBetterRepresentative(lhsRoot, rhsRoot)) parent.at(rhsRoot) = lhsRoot;
+        else parent.at(lhsRoot) = rhsRoot;
+    }
+};
+
+inline bool IsAlias(const z3::expr& expr) {
+    if (!expr.is_eq() || expr.num_args() != 2) return false;
+    auto lhs = expr.arg(0), rhs = expr.arg(1);
+    if (IsConstant(lhs)) return IsConstant(rhs) || IsValue(rhs);
+    return IsValue(lhs) && IsConstant(rhs);
+}
+
+inline z3::tactic MakeTactic(z3::context& context, const std::string& tactics) {
+    std::optional<z3::tactic> result;
+    std::stringstream stream(tactics);
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        if (name.empty()) continue;
+        try {
+            z3::tactic tactic(context, name.c_str());
+            result = result ? z3::tactic(*result & tactic) : tactic;
+        } catch (const z3::exception& err) {
+            throw std::logic_error("Unknown Z3 tactic '" + name + "'."); // TODO: better error handling
+        }
+    }
+    return result ? *result : z3::tactic(context, "skip");
+}
+
+
+PreprocessedPremise::PreprocessedPremise(z3::context& context) : premise(context), replace(context), with(context) {}
+
+z3::expr PreprocessedPremise::Apply(const z3::expr& expr) const {
+    if (replace.empty()) return expr;
+    return z3::expr(expr).substitute(replace, with);
+}
+
+PreprocessedPremise plankton::Preprocess(const z3::expr& premise, const std::string& tactics) {
+    auto& context = premise.ctx();
+    PreprocessedPremise result(context);
+
+    // find aliases
+    std::vector<z3::expr> conjuncts;
+    Flatten(premise, conjuncts);
+    AliasClasses aliases;
+    for (const auto& conjunct : conjuncts) {
+        if (IsAlias(conjunct)) aliases.Union(conjunct.arg(0), conjunct.arg(1));
+    }
+    for (const auto& [id, member] : aliases.members) {
+        auto representative = aliases.Find(id);
+        if (representative == id || IsValue(member)) continue;
+        result.replace.push_back(member);
+        result.with.push_back(aliases.members.at(representative));
+    }
+
+    // eliminate aliases, equalities that became trivial are dropped, contradicting values are kept
+    z3::goal goal(context);
+    for (const auto& conjunct : conjuncts) {
+        auto substituted = result.Apply(conjunct);
+        if (substituted.is_eq() && z3::eq(substituted.arg(0), substituted.arg(1))) continue;
+        goal.add(substituted);
+    }
+
+    // simplify
+    auto subgoals = MakeTactic(context, tactics)(goal);
+    z3::expr_vector disjuncts(context);
+    for (unsigned index = 0; index < subgoals.size(); ++index) disjuncts.push_back(subgoals[(int) index].as_expr());
+    result.premise = z3::mk_or(disjuncts);
+    return result;
+}
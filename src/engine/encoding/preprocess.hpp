@@ -0,0 +1,35 @@
+#pragma once
+#ifndef PLANKTON_ENGINE_PREPROCESS_HPP
+#define PLANKTON_ENGINE_PREPROCESS_HPP
+
+#include "internal.hpp"
+
+namespace plankton {
+
+    /**
+     * A premise with its aliases eliminated and simplified by a tactic pipeline, together with the substitution
+     * that must be applied to expressions checked against it.
+     */
+    struct PreprocessedPremise {
+        z3::expr premise;
+        z3::expr_vector replace, with;
+
+        explicit PreprocessedPremise(z3::context& context);
+        [[nodiscard]] z3::expr Apply(const z3::expr& expr) const;
+    };
+
+    /**
+     * Eliminates aliases, i.e., top-level equalities among constants and between constants and values, like the
+     * ones produced by renaming symbols: each class of equal constants is replaced by a single representative,
+     * preferably a value. Afterwards, the remainder is simplified by the given comma-separated list of Z3 tactics.
+     * The tactics must preserve equivalence, not only satisfiability; tactics that eliminate variables, like
+     * 'solve-eqs', would silently drop constraints of constants the substitution does not know of.
+     *
+     * The result is equivalent to 'premise' modulo the substitution: 'premise' implies 'expr' if and only if
+     * the result's premise implies the result applied to 'expr'.
+     */
+    PreprocessedPremise Preprocess(const z3::expr& premise, const std::string& tactics);
+
+} // namespace plankton
+
+#endif //PLANKTON_ENGINE_PREPROCESS_HPP
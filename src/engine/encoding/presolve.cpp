@@ -0,0 +1,287 @@
+#include "presolve.hpp"
+
+#include <limits>
+#include <algorithm>
+
+using namespace plankton;
+
+static constexpr std::size_t MAX_ORDERED_CLASSES = 192; // the difference-bound matrix is closed in cubic time
+static constexpr unsigned int MAX_BIT_WIDTH = 62;
+static constexpr long long INFINITE = std::numeric_limits<long long>::max() / 4;
+
+
+inline long long Add(long long bound, long long other) {
+    // saturates in both directions, so that repeated additions along negative cycles do not overflow
+    if (bound >= INFINITE || other >= INFINITE) return INFINITE;
+    return std::max(bound + other, -INFINITE);
+}
+
+inline bool IsOrdered(const z3::sort& sort) {
+    return sort.is_int() || (sort.is_bv() && sort.bv_size() <= MAX_BIT_WIDTH);
+}
+
+inline std::optional<long long> GetValue(const z3::expr& expr) {
+    if (!expr.is_numeral()) return std::nullopt;
+    auto sort = expr.get_sort();
+    if (sort.is_int()) {
+        int64_t result;
+        if (expr.is_numeral_i64(result) && result > -INFINITE && result < INFINITE) return result;
+    } else if (sort.is_bv() && sort.bv_size() <= MAX_BIT_WIDTH) {
+        // data values are compared as signed bitvectors
+        uint64_t result;
+        if (!expr.is_numeral_u64(result)) return std::nullopt;
+        auto width = sort.bv_size();
+        if (width > 0 && (result >> (width - 1)) != 0) return (long long) result - (1LL << width);
+        return (long long) result;
+    }
+    return std::nullopt;
+}
+
+inline bool IsTerm(const z3::expr& expr) {
+    if (expr.is_bool()) return false;
+    if (expr.is_numeral()) return !IsOrdered(expr.get_sort()) || GetValue(expr).has_value();
+    return expr.is_const() && expr.decl().decl_kind() == Z3_OP_UNINTERPRETED;
+}
+
+
+//
+// Atoms
+//
+
+enum struct Relation { EQ, NEQ, LEQ, LT };
+
+struct Atom {
+    Relation relation;
+    z3::expr lhs, rhs;
+};
+
+inline std::optional<Atom> MakeAtom(const z3::expr& expr, bool negated = false) {
+    if (!expr.is_app()) return std::nullopt;
+    if (expr.is_not()) return MakeAtom(expr.arg(0), !negated);
+    if (expr.num_args() != 2) return std::nullopt;
+    auto lhs = expr.arg(0), rhs = expr.arg(1);
+    if (!IsTerm(lhs) || !IsTerm(rhs)) return std::nullopt;
+    auto isOrdered = IsOrdered(lhs.get_sort());
+    auto isInt = lhs.get_sort().is_int();
+
+    // normalize to 'lhs op rhs' with 'op' being =, !=, <=, or <
+    auto make = [&](Relation relation, bool swap) -> Atom {
+        if (negated) {
+            switch (relation) {
+                case Relation::EQ: relation = Relation::NEQ; break;
+                case Relation::NEQ: relation = Relation::EQ; break;
+                case Relation::LEQ: relation = Relation::LT; swap = !swap; break;
+                case Relation::LT: relation = Relation::LEQ; swap = !swap; break;
+            }
+        }
+        return swap ? Atom{ relation, rhs, lhs } : Atom{ relation, lhs, rhs };
+    };
+    switch (expr.decl().decl_kind()) {
+        case Z3_OP_EQ: return make(Relation::EQ, false);
+        case Z3_OP_DISTINCT: return make(Relation::NEQ, false);
+        case Z3_OP_LE: if (isInt) return make(Relation::LEQ, false); break;
+        case Z3_OP_LT: if (isInt) return make(Relation::LT, false); break;
+        case Z3_OP_GE: if (isInt) return make(Relation::LEQ, true); break;
+        case Z3_OP_GT: if (isInt) return make(Relation::LT, true); break;
+        case Z3_OP_SLEQ: if (isOrdered) return make(Relation::LEQ, false); break;
+        case Z3_OP_SLT: if (isOrdered) return make(Relation::LT, false); break;
+        case Z3_OP_SGEQ: if (isOrdered) return make(Relation::LEQ, true); break;
+        case Z3_OP_SGT: if (isOrdered) return make(Relation::LT, true); break;
+        default: break;
+    }
+    return std::nullopt;
+}
+
+inline void Flatten(const z3::expr& expr, std::vector<z3::expr>& result) {
+    if (expr.is_and()) {
+        for (unsigned index = 0; index < expr.num_args(); ++index) Flatten(expr.arg(index), result);
+    } else {
+        result.push_back(expr);
+    }
+}
+
+
+//
+// Construction
+//
+
+std::size_t StackPresolver::GetNode(const z3::expr& term) {
+    auto find = termToNode.find(term.id());
+    if (find != termToNode.end()) return find->second;
+    auto node = parent.size();
+    termToNode.emplace(term.id(), node);
+    parent.push_back(node);
+    tag.push_back(term.is_numeral() ? std::make_optional(term.id()) : std::nullopt);
+    value.push_back(GetValue(term));
+    return node;
+}
+
+std::size_t StackPresolver::Find(std::size_t node) const {
+    while (parent.at(node) != node) node = parent.at(node);
+    return node;
+}
+
+void StackPresolver::Union(std::size_t node, std::size_t other) {
+    node = Find(node);
+    other = Find(other);
+    if (node == other) return;
+    if (tag.at(node) && tag.at(other)) inconsistent = true; // distinct values
+    if (!tag.at(node)) tag.at(node) = tag.at(other);
+    if (!value.at(node)) value.at(node) = value.at(other);
+    parent.at(other) = node;
+}
+
+void StackPresolver::Constrain(std::size_t node, std::size_t other, Bound bound) {
+    auto& entry = distance.at(rootToIndex.at(Find(node))).at(rootToIndex.at(Find(other)));
+    entry = std::min(entry, bound);
+}
+
+void StackPresolver::Close() {
+    auto size = distance.size();
+    for (std::size_t via = 0; via < size; ++via) {
+        for (std::size_t from = 0; from < size; ++from) {
+            if (distance[from][via] >= INFINITE) continue;
+            for (std::size_t to = 0; to < size; ++to) {
+                auto bound = Add(distance[from][via], distance[via][to]);
+                if (bound < distance[from][to]) distance[from][to] = bound;
+            }
+            if (distance[from][from] < 0) {
+                // negative cycle, the ordering is unsatisfiable
+                inconsistent = true;
+                return;
+            }
+        }
+    }
+    for (std::size_t index = 0; index < size; ++index) {
+        if (distance[index][index] < 0) inconsistent = true;
+    }
+}
+
+StackPresolver::StackPresolver(const z3::expr& premise_) : premise(premise_) {
+    std::vector<z3::expr> conjuncts;
+    Flatten(premise, conjuncts);
+    std::vector<Atom> atoms;
+    for (const auto& conjunct : conjuncts) {
+        if (conjunct.is_false()) inconsistent = true;
+        if (auto atom = MakeAtom(conjunct)) atoms.push_back(std::move(*atom));
+    }
+
+    // equalities
+    for (const auto& atom : atoms) {
+        auto lhs = GetNode(atom.lhs), rhs = GetNode(atom.rhs);
+        if (atom.relation == Relation::EQ) Union(lhs, rhs);
+    }
+
+    // orderings
+    std::set<std::size_t> ordered;
+    for (const auto& atom : atoms) {
+        if (!IsOrdered(atom.lhs.get_sort())) continue;
+        ordered.insert(Find(GetNode(atom.lhs)));
+        ordered.insert(Find(GetNode(atom.rhs)));
+    }
+    if (ordered.size() >= MAX_ORDERED_CLASSES) {
+        usable = false;
+        return;
+    }
+    distance.assign(ordered.size() + 1, std::vector<Bound>(ordered.size() + 1, INFINITE));
+    for (std::size_t index = 0; index < distance.size(); ++index) distance[index][index] = 0;
+    for (auto root : ordered) {
+        auto index = rootToIndex.size() + 1;
+        rootToIndex.emplace(root, index);
+        if (!value.at(root)) continue;
+        distance[index][0] = *value.at(root);
+        distance[0][index] = -*value.at(root);
+    }
+    for (const auto& atom : atoms) {
+        auto lhs = GetNode(atom.lhs), rhs = GetNode(atom.rhs);
+        if (atom.relation == Relation::NEQ) {
+            disequalities.emplace(Find(lhs), Find(rhs));
+            disequalities.emplace(Find(rhs), Find(lhs));
+        }
+        if (!IsOrdered(atom.lhs.get_sort())) continue;
+        switch (atom.relation) {
+            case Relation::EQ: Constrain(lhs, rhs, 0); Constrain(rhs, lhs, 0); break;
+            case Relation::LEQ: Constrain(lhs, rhs, 0); break;
+            case Relation::LT: Constrain(lhs, rhs, -1); break;
+            case Relation::NEQ: break;
+        }
+    }
+    Close();
+
+    // disequalities among classes that are forced to be equal
+    for (const auto& [lhs, rhs] : disequalities) {
+        if (lhs == rhs) inconsistent = true;
+        auto lhsIndex = rootToIndex.find(lhs), rhsIndex = rootToIndex.find(rhs);
+        if (lhsIndex == rootToIndex.end() || rhsIndex == rootToIndex.end()) continue;
+        if (distance[lhsIndex->second][rhsIndex->second] <= 0 && distance[rhsIndex->second][lhsIndex->second] <= 0) {
+            inconsistent = true;
+        }
+    }
+}
+
+const z3::expr& StackPresolver::GetPremise() const {
+    return premise;
+}
+
+
+//
+// Queries
+//
+
+struct StackPresolver::Operand {
+    unsigned id;
+    std::optional<std::size_t> root;
+    std::optional<std::size_t> index; // in 'distance'
+    long long offset = 0; // value of the operand minus value of 'index'
+    std::optional<unsigned> tag;
+};
+
+StackPresolver::Operand StackPresolver::Resolve(const z3::expr& term) const {
+    Operand result;
+    result.id = term.id();
+    auto find = termToNode.find(term.id());
+    if (find != termToNode.end()) {
+        result.root = Find(find->second);
+        result.tag = tag.at(*result.root);
+        auto index = rootToIndex.find(*result.root);
+        if (index != rootToIndex.end()) result.index = index->second;
+    } else if (term.is_numeral()) {
+        // values unknown to the premise are offsets of zero
+        result.tag = term.id();
+        if (auto termValue = GetValue(term)) {
+            result.index = 0;
+            result.offset = *termValue;
+        }
+    }
+    return result;
+}
+
+StackPresolver::Bound StackPresolver::GetBound(const Operand& lhs, const Operand& rhs) const {
+    if (lhs.id == rhs.id) return 0;
+    if (!lhs.index || !rhs.index) return INFINITE;
+    return Add(distance[*lhs.index][*rhs.index], lhs.offset - rhs.offset);
+}
+
+bool StackPresolver::IsImplied(const z3::expr& expr) const {
+    if (!usable) return false;
+    if (inconsistent || expr.is_true()) return true;
+    auto atom = MakeAtom(expr);
+    if (!atom) return false;
+    auto lhs = Resolve(atom->lhs), rhs = Resolve(atom->rhs);
+
+    switch (atom->relation) {
+        case Relation::EQ:
+            if (lhs.id == rhs.id || (lhs.root && lhs.root == rhs.root)) return true;
+            if (lhs.tag && lhs.tag == rhs.tag) return true;
+            return GetBound(lhs, rhs) <= 0 && GetBound(rhs, lhs) <= 0;
+        case Relation::NEQ:
+            if (lhs.tag && rhs.tag && lhs.tag != rhs.tag) return true;
+            if (lhs.root && rhs.root && disequalities.count({ *lhs.root, *rhs.root }) != 0) return true;
+            return GetBound(lhs, rhs) <= -1 || GetBound(rhs, lhs) <= -1;
+        case Relation::LEQ:
+            return GetBound(lhs, rhs) <= 0;
+        case Relation::LT:
+            return GetBound(lhs, rhs) <= -1;
+    }
+    return false;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#ifndef PLANKTON_ENGINE_PRESOLVE_HPP
+#define PLANKTON_ENGINE_PRESOLVE_HPP
+
+#include <map>
+#include <set>
+#include <vector>
+#include <optional>
+#include "z3++.h"
+
+namespace plankton {
+
+    /**
+     * Native decision procedure for the stack part of a premise, i.e., its top-level equalities, disequalities,
+     * and orderings among constants and values, like the axioms 'MakeStackCandidates' produces. Equalities are
+     * tracked by union-find, orderings of integers (resp. signed bitvectors) by a difference-bound matrix.
+     *
+     * All other parts of the premise are ignored. Hence, the presolver proves implications but never refutes
+     * them: a negative answer means that Z3 has to decide.
+     */
+    struct StackPresolver final {
+        explicit StackPresolver(const z3::expr& premise);
+
+        [[nodiscard]] const z3::expr& GetPremise() const;
+        [[nodiscard]] bool IsImplied(const z3::expr& expr) const;
+
+        private:
+            using Bound = long long; // 'x - y <= bound'
+            struct Operand;
+
+            z3::expr premise;
+            bool usable = true;
+            bool inconsistent = false;
+            std::map<unsigned, std::size_t> termToNode; // by AST id
+            std::vector<std::size_t> parent;
+            std::vector<std::optional<unsigned>> tag; // AST id of the value a class contains, by root
+            std::vector<std::optional<Bound>> value; // integer value of values, by node
+            std::set<std::pair<std::size_t, std::size_t>> disequalities; // between roots
+            std::map<std::size_t, std::size_t> rootToIndex; // ordered classes in 'distance', index 0 is zero
+            std::vector<std::vector<Bound>> distance;
+
+            std::size_t GetNode(const z3::expr& term);
+            std::size_t Find(std::size_t node) const;
+            void Union(std::size_t node, std::size_t other);
+            void Constrain(std::size_t node, std::size_t other, Bound bound);
+            void Close();
+            [[nodiscard]] Operand Resolve(const z3::expr& term) const;
+            [[nodiscard]] Bound GetBound(const Operand& lhs, const Operand& rhs) const;
+    };
+
+} // namespace plankton
+
+#endif //PLANKTON_ENGINE_PRESOLVE_HPP
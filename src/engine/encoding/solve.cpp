@@ -1,28 +1,67 @@
 #include "engine/encoding.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <algorithm>
-#include <random>
-#include <thread>
 #include <mutex>
 #include "internal.hpp"
+#include "pool.hpp"
+#include "async.hpp"
+#include "backend.hpp"
+#include "ground.hpp"
+#include "preprocess.hpp"
+#include "portfolio.hpp"
 #include "util/shortcuts.hpp"
 #include "util/timer.hpp"
 
 using namespace plankton;
 
-static constexpr std::size_t BATCH_SIZE = 16;
-static constexpr std::size_t PARALLEL_THRESHOLD = 3 * BATCH_SIZE;
-static constexpr std::size_t FALLBACK_THREAD_COUNT = 8;
+static constexpr std::size_t PARALLEL_THRESHOLD_BATCHES = 3;
 
 
+struct SolvingFailure : std::logic_error {
+    explicit SolvingFailure() : std::logic_error("Solving failed: Z3 returned z3::unknown.") {} // TODO: better error handling
+};
+
 struct PreferredMethodFailed : std::exception {
     [[nodiscard]] const char* what() const noexcept override {
         return "SMT solving failed: Z3 was unable to prove/disprove satisfiability; solving result was 'UNKNOWN'.";
     }
 };
 
-inline z3::expr Translate(const z3::expr& expr, const z3::context& srcContext, z3::context& dstContext) {
-    return z3::to_expr(dstContext, Z3_translate(srcContext, expr, dstContext));
+struct BudgetExhausted : std::exception {
+    [[nodiscard]] const char* what() const noexcept override {
+        return "SMT solving failed: the query exceeded its time or resource budget.";
+    }
+};
+
+inline bool IsBudgetExhausted(const std::string& reasonUnknown) {
+    // reasons Z3 reports for 'timeout' and 'rlimit', see 'MakeBudget'
+    return reasonUnknown.find("timeout") != std::string::npos
+           || reasonUnknown.find("canceled") != std::string::npos
+           || reasonUnknown.find("resource") != std::string::npos;
+}
+
+//
+// Statistics
+//
+
+struct {
+    std::atomic<std::size_t> undecided = 0;
+    std::atomic<std::size_t> decidedByRetry = 0;
+    std::atomic<std::size_t> decidedByPortfolio = 0;
+    std::atomic<std::size_t> assumedNotImplied = 0;
+    std::atomic<std::size_t> failed = 0;
+} statistics;
+
+SolvingStatistics plankton::GetSolvingStatistics() {
+    SolvingStatistics result;
+    result.undecided = statistics.undecided;
+    result.decidedByRetry = statistics.decidedByRetry;
+    result.decidedByPortfolio = statistics.decidedByPortfolio;
+    result.assumedNotImplied = statistics.assumedNotImplied;
+    result.failed = statistics.failed;
+    return result;
 }
 
 
@@ -30,14 +69,67 @@ inline z3::expr Translate(const z3::expr& expr, const z3::context& srcContext, z
 // Z3 handling
 //
 
+inline z3::check_result CheckWithBudget(z3::solver& solver, const z3::expr& query, std::size_t scale) {
+    solver.push();
+    solver.add(query);
+    SetBudget(solver, scale);
+    auto res = solver.check();
+    SetBudget(solver);
+    solver.pop();
+    return res;
+}
+
+inline z3::check_result Escalate(z3::solver& solver, const z3::expr& query) {
+    // invoked after Z3 returned 'unknown' for 'query', expects 'query' to be removed from 'solver' again
+    const auto& setup = GetEncodingSetup();
+    ++statistics.undecided;
+    if (HasBudget(setup) && setup.smtBudgetEscalation > 1) {
+        auto res = CheckWithBudget(solver, query, setup.smtBudgetEscalation);
+        if (res != z3::unknown) {
+            ++statistics.decidedByRetry;
+            return res;
+        }
+    }
+    if (setup.smtPortfolio) {
+        auto res = SolveWithPortfolio(solver, query);
+        if (res != z3::unknown) {
+            ++statistics.decidedByPortfolio;
+            return res;
+        }
+    }
+    return z3::unknown;
+}
+
+inline bool IsImpliedOrAssumeNot(const ImplicationCheck& isImplied, z3::solver& solver, const z3::expr& expr) {
+    // sound for batch checks only: clients treat checks that do not hold conservatively
+    try {
+        return isImplied(solver, expr);
+    } catch (const SolvingFailure& err) {
+        ++statistics.assumedNotImplied;
+        return false;
+    }
+}
+
 inline bool IsUnsat(z3::solver& solver) {
     solver.push();
     auto res = solver.check();
     solver.pop();
+    if (res == z3::unknown) res = Escalate(solver, solver.ctx().bool_val(true));
     switch (res) {
         case z3::unsat: return true;
         case z3::sat: return false;
-        case z3::unknown: throw std::logic_error("Solving failed: Z3 returned z3::unknown."); // TODO: better error handling
+        case z3::unknown: throw SolvingFailure();
+    }
+    throw;
+}
+
+inline bool IsUnsatNoScope(z3::solver& solver) {
+    auto res = solver.check();
+    if (res == z3::unknown) res = Escalate(solver, solver.ctx().bool_val(true));
+    switch (res) {
+        case z3::unsat: return true;
+        case z3::sat: return false;
+        case z3::unknown: throw SolvingFailure();
     }
     throw;
 }
@@ -47,135 +139,163 @@ inline bool IsImplied(z3::solver& solver, const z3::expr& expr) {
     solver.add(!expr);
     auto res = solver.check();
     solver.pop();
+    if (res == z3::unknown) res = Escalate(solver, !expr);
     switch (res) {
         case z3::unsat: return true;
         case z3::sat: return false;
-        case z3::unknown: throw std::logic_error("Solving failed: Z3 returned z3::unknown."); // TODO: better error handling
+        case z3::unknown: throw SolvingFailure();
     }
     throw;
 }
 
+inline bool IsImpliedUnderSelector(z3::solver& solver, const z3::expr& expr) {
+    auto selector = MakeSelector(solver.ctx());
+    solver.add(z3::implies(selector, !expr));
+    z3::expr_vector assumptions(solver.ctx());
+    assumptions.push_back(selector);
+    auto res = solver.check(assumptions);
+    solver.add(!selector);
+    if (res == z3::unknown) res = Escalate(solver, !expr);
+    switch (res) {
+        case z3::unsat: return true;
+        case z3::sat: return false;
+        case z3::unknown: throw SolvingFailure();
+    }
+    throw;
+}
 
-//
-// Batch solving
-//
-
-inline std::vector<bool> ComputeImpliedOneAtATimeSequential(z3::solver& solver, const std::deque<EExpr>& expressions);
-inline std::vector<bool> ComputeImpliedOneAtATimeParallel(z3::solver& solver, const std::deque<EExpr>& expressions);
 
-inline std::vector<bool> ComputeImpliedOneAtATime(z3::solver& solver, const std::deque<EExpr>& expressions) {
-    if (solver.check() == z3::unsat) return std::vector<bool>(expressions.size(), true);
-    if (expressions.size() < PARALLEL_THRESHOLD) return ComputeImpliedOneAtATimeSequential(solver, expressions);
-    else return ComputeImpliedOneAtATimeParallel(solver, expressions);
+inline bool UseSelectors() {
+    return GetEncodingSetup().smtMethod == SmtMethod::ASSUMPTIONS;
 }
 
-inline std::vector<bool> ComputeImpliedOneAtATimeSequential(z3::solver& solver, const std::deque<EExpr>& expressions) {
-    std::vector<bool> result;
-    result.reserve(expressions.size());
-    for (const auto& check : expressions) {
-        result.push_back(IsImplied(solver, AsExpr(check)));
+inline std::pair<z3::check_result, z3::model> FindModel(z3::solver& solver, const z3::expr& expr) {
+    // finds a model of the solver's assertions and 'expr', without retaining 'expr'
+    auto& context = solver.ctx();
+    z3::check_result res;
+    z3::model model(context);
+    if (UseSelectors()) {
+        auto selector = MakeSelector(context);
+        solver.add(z3::implies(selector, expr));
+        z3::expr_vector assumptions(context);
+        assumptions.push_back(selector);
+        res = solver.check(assumptions);
+        if (res == z3::sat) model = solver.get_model();
+        solver.add(!selector);
+    } else {
+        solver.push();
+        solver.add(expr);
+        res = solver.check();
+        if (res == z3::sat) model = solver.get_model();
+        solver.pop();
     }
-    return result;
-}
-
-inline std::size_t GetThreadCount() {
-    auto result = std::thread::hardware_concurrency();
-    if (result > 0) return result * 2;
-    return FALLBACK_THREAD_COUNT;
+    return { res, model };
 }
 
-struct Task {
-    std::size_t id;
-    z3::expr expr;
-    explicit Task(std::size_t id, const z3::expr& expr) : id(id), expr(expr) {}
-};
 
-struct Result {
-    std::size_t id;
-    bool implied;
-    Result(const Task& task, bool implied) : id(task.id), implied(implied) {}
-};
+//
+// Model-based filtering
+//
 
-struct TaskPool {
-    z3::context& srcContext;
-    z3::solver& srcSolver;
-    std::vector<Task> tasks;
-    std::vector<Result> results;
-    std::mutex takeMutex;
-    std::mutex putMutex;
-
-    explicit TaskPool(const std::deque<EExpr>& expressions, z3::solver& solver) : srcContext(solver.ctx()), srcSolver(solver) {
-        tasks.reserve(expressions.size());
-        for (std::size_t index = 0; index < expressions.size(); ++index) {
-            tasks.emplace_back(index, AsExpr(expressions.at(index)));
+/**
+ * Houdini-style elimination: repeatedly asks for a model of the premise that falsifies some undecided check.
+ * Checks that evaluate to false in such a model are not implied. If no such model exists, all undecided checks
+ * are implied. Sets 'result' for the decided checks and returns the indices of the checks that remain undecided,
+ * because the round limit was hit, a model did not decide any check, or Z3 returned 'unknown'.
+ */
+inline std::vector<std::size_t> FilterByModel(z3::solver& solver, const std::deque<EExpr>& expressions,
+                                              std::vector<bool>& result) {
+    MEASURE("ComputeImplied ~> FilterByModel")
+    std::vector<std::size_t> undecided;
+    undecided.reserve(expressions.size());
+    for (std::size_t index = 0; index < expressions.size(); ++index) undecided.push_back(index);
+
+    for (std::size_t round = 0; round < GetEncodingSetup().smtFilterMaxRounds && !undecided.empty(); ++round) {
+        z3::expr_vector refutations(solver.ctx());
+        for (auto index : undecided) refutations.push_back(!AsExpr(expressions.at(index)));
+        auto [res, model] = FindModel(solver, z3::mk_or(refutations));
+        if (res == z3::unknown) break;
+        if (res == z3::unsat) {
+            for (auto index : undecided) result.at(index) = true;
+            undecided.clear();
+            break;
         }
-        std::shuffle(tasks.begin(), tasks.end(), std::default_random_engine());
-    }
 
-    std::vector<Task> Take(z3::solver& dstSolver) {
-        std::lock_guard guard(takeMutex);
-        auto& dstContext = dstSolver.ctx();
-        auto result = plankton::MakeVector<Task>(BATCH_SIZE);
-        for (std::size_t index = 0; index < BATCH_SIZE && !tasks.empty(); ++index) {
-            result.push_back(tasks.back());
-            result.back().expr = Translate(result.back().expr, srcContext, dstContext);
-            tasks.pop_back();
-        }
-        return result;
+        auto size = undecided.size();
+        plankton::RemoveIf(undecided, [&](auto index){
+            if (!model.eval(AsExpr(expressions.at(index)), true).is_false()) return false;
+            result.at(index) = false;
+            return true;
+        });
+        if (undecided.size() == size) break;
     }
+    return undecided;
+}
 
-    void Put(std::vector<Result> res) {
-        std::lock_guard guard(putMutex);
-        plankton::MoveInto(std::move(res), results);
-    }
-};
 
-inline void Work(TaskPool& pool) {
-    z3::context context;
-    z3::solver solver(context);
-    std::unique_lock guard(pool.takeMutex);
-    auto premise = z3::mk_and(pool.srcSolver.assertions());
-    solver.add(Translate(premise, pool.srcContext, context));
-    guard.unlock();
-
-    while (true) {
-        auto tasks = pool.Take(solver);
-        if (tasks.empty()) break;
-        auto results = plankton::MakeVector<Result>(tasks.size());
-        for (const auto& task : tasks) {
-            bool implied = IsImplied(solver, task.expr);
-            // DEBUG("." << std::flush)
-            results.emplace_back(task, implied);
-        }
-        pool.Put(std::move(results));
-    }
+//
+// Batch solving
+//
+
+inline std::vector<bool> ComputeImpliedOneAtATimeSequential(z3::solver& solver, const std::deque<EExpr>& expressions,
+                                                             const ImplicationCheck& isImplied);
+inline std::vector<bool> ComputeImpliedOneAtATimeParallel(Z3InternalStorage& storage, z3::solver& solver,
+                                                           const std::deque<EExpr>& expressions,
+                                                           const ImplicationCheck& isImplied);
+
+inline bool UseParallel(const std::deque<EExpr>& expressions) {
+    auto& pool = WorkerPool::Get();
+    if (pool.GetWorkerCount() == 0) return false;
+    return expressions.size() >= PARALLEL_THRESHOLD_BATCHES * pool.GetBatchSize();
 }
 
-inline std::vector<bool> ComputeImpliedOneAtATimeParallel(z3::solver& solver, const std::deque<EExpr>& expressions) {
-    static const std::size_t THREAD_COUNT = GetThreadCount();
+inline std::vector<bool> ComputeImpliedOneAtATime(Z3InternalStorage& storage, z3::solver& solver,
+                                                   const std::deque<EExpr>& expressions,
+                                                   const ImplicationCheck& isImplied) {
+    if (solver.check() == z3::unsat) return std::vector<bool>(expressions.size(), true);
+    if (!UseParallel(expressions)) return ComputeImpliedOneAtATimeSequential(solver, expressions, isImplied);
+    else return ComputeImpliedOneAtATimeParallel(storage, solver, expressions, isImplied);
+}
 
-    // DEBUG("#threads=" << THREAD_COUNT << " #expr=" << expressions.size() << " " << std::flush)
-    TaskPool taskPool(expressions, solver);
-    std::deque<std::thread> threads;
-    for (std::size_t index = 0; index < THREAD_COUNT; ++index) {
-        threads.emplace_back([&taskPool](){
-            Work(taskPool);
-        });
-    }
-    for (auto& thread : threads) thread.join();
-    // DEBUG(std::endl)
+inline std::vector<bool> ComputeImpliedOneAtATime(Z3InternalStorage& storage, z3::solver& solver,
+                                                   const std::deque<EExpr>& expressions) {
+    MEASURE("ComputeImplied ~> OneAtATime")
+    return ComputeImpliedOneAtATime(storage, solver, expressions, [](z3::solver& solver, const z3::expr& expr){
+        return IsImpliedOrAssumeNot(IsImplied, solver, expr);
+    });
+}
 
-    std::vector<bool> result(expressions.size());
-    for (const auto& elem : taskPool.results) result.at(elem.id) = elem.implied;
+inline std::vector<bool> ComputeImpliedUnderSelectors(Z3InternalStorage& storage, z3::solver& solver,
+                                                      const std::deque<EExpr>& expressions) {
+    MEASURE("ComputeImplied ~> UnderSelectors")
+    return ComputeImpliedOneAtATime(storage, solver, expressions, [](z3::solver& solver, const z3::expr& expr){
+        return IsImpliedOrAssumeNot(IsImpliedUnderSelector, solver, expr);
+    });
+}
+
+inline std::vector<bool> ComputeImpliedOneAtATimeSequential(z3::solver& solver, const std::deque<EExpr>& expressions,
+                                                             const ImplicationCheck& isImplied) {
+    std::vector<bool> result;
+    result.reserve(expressions.size());
+    for (const auto& check : expressions) {
+        result.push_back(isImplied(solver, AsExpr(check)));
+    }
     return result;
 }
 
+inline std::vector<bool> ComputeImpliedOneAtATimeParallel(Z3InternalStorage& storage, z3::solver& solver,
+                                                           const std::deque<EExpr>& expressions,
+                                                           const ImplicationCheck& isImplied) {
+    return WorkerPool::Get().ComputeImplied(storage, solver, expressions, isImplied);
+}
+
 
 //
 // Backbone solving
 //
 
 inline std::vector<bool> ComputeImpliedInOneShot(z3::solver& solver, const std::deque<EExpr>& expressions) {
+    MEASURE("ComputeImplied ~> InOneShot")
     // prepare required vectors
     solver.push();
     auto& context = solver.ctx();
@@ -193,12 +313,14 @@ inline std::vector<bool> ComputeImpliedInOneShot(z3::solver& solver, const std::
 
     // check
     auto answer = solver.consequences(assumptions, variables, consequences);
+    auto exhausted = answer == z3::unknown && HasBudget(GetEncodingSetup()) && IsBudgetExhausted(solver.reason_unknown());
     solver.pop();
 
     // create result
     std::vector<bool> result(expressions.size(), false);
     switch (answer) {
         case z3::unknown:
+            if (exhausted) throw BudgetExhausted();
             throw PreferredMethodFailed();
 
         case z3::unsat:
@@ -223,6 +345,62 @@ inline std::vector<bool> ComputeImpliedInOneShot(z3::solver& solver, const std::
     throw;
 }
 
+/**
+ * Computes the backbone without 'solver::consequences'. Undecided checks are processed in chunks: if the premise
+ * together with the disjunction of a chunk's negations is unsatisfiable, the whole chunk is implied and the chunk size
+ * grows. Otherwise, the model eliminates all undecided checks it falsifies and the chunk size shrinks. A single
+ * check whose refutation is satisfiable is not implied, even if the model does not evaluate it.
+ */
+inline std::vector<bool> ComputeImpliedByBackbone(z3::solver& solver, const std::deque<EExpr>& expressions) {
+    MEASURE("ComputeImplied ~> ByBackbone")
+    std::vector<bool> result(expressions.size(), false);
+    std::deque<std::size_t> undecided;
+    for (std::size_t index = 0; index < expressions.size(); ++index) undecided.push_back(index);
+
+    auto chunkSize = undecided.size();
+    while (!undecided.empty()) {
+        chunkSize = std::clamp<std::size_t>(chunkSize, 1, undecided.size());
+        z3::expr_vector refutations(solver.ctx());
+        for (std::size_t index = 0; index < chunkSize; ++index) {
+            refutations.push_back(!AsExpr(expressions.at(undecided.at(index))));
+        }
+
+        auto [res, model] = FindModel(solver, z3::mk_or(refutations));
+        switch (res) {
+            case z3::unsat:
+                for (std::size_t index = 0; index < chunkSize; ++index) {
+                    result.at(undecided.front()) = true;
+                    undecided.pop_front();
+                }
+                chunkSize *= 2;
+                break;
+
+            case z3::sat: {
+                auto size = undecided.size();
+                plankton::RemoveIf(undecided, [&](auto index){
+                    return model.eval(AsExpr(expressions.at(index)), true).is_false();
+                });
+                if (undecided.size() == size && chunkSize == 1) undecided.pop_front();
+                chunkSize /= 2;
+                break;
+            }
+
+            case z3::unknown:
+                if (chunkSize > 1) {
+                    chunkSize /= 2;
+                    break;
+                }
+                switch (Escalate(solver, refutations[0])) {
+                    case z3::unsat: result.at(undecided.front()) = true; undecided.pop_front(); break;
+                    case z3::sat: undecided.pop_front(); break;
+                    case z3::unknown: ++statistics.assumedNotImplied; undecided.pop_front(); break;
+                }
+                break;
+        }
+    }
+    return result;
+}
+
 
 //
 // Adaptive method choosing
@@ -242,21 +420,24 @@ inline std::string GetZ3Version() {
 
 struct MethodChooser {
     // TODO: identify working method beforehand (during construction)
-    bool fallback = false;
+    std::atomic<bool> fallback = false; // shared with the solving service
 
     inline std::vector<bool> operator()(z3::solver& solver, const std::deque<EExpr>& expressions) {
-        if (fallback) return ComputeImpliedOneAtATime(solver, expressions);
+        if (fallback) return ComputeImpliedByBackbone(solver, expressions);
         try {
             return ComputeImpliedInOneShot(solver, expressions);
+        } catch (const BudgetExhausted& err) {
+            // not a failure of the method: the backbone decides the batch in smaller queries, escalating budgets
+            return ComputeImpliedByBackbone(solver, expressions);
         } catch (const PreferredMethodFailed& err) {
             std::stringstream warning;
             warning << "solving failure with Z3's solver::consequences! "
                     << "This issue is known to happen for versions >4.8.7, your version is " << GetZ3Version()
-                    << ". Using fallback, performance may degrade..." << std::endl;
+                    << ". Using backbone computation as fallback..." << std::endl;
             WARNING(warning.str())
             static LateWarning lateWarning(warning.str());
             fallback = true;
-            return ComputeImpliedOneAtATime(solver, expressions);
+            return ComputeImpliedByBackbone(solver, expressions);
         }
     }
 } solvingMethod;
@@ -315,36 +496,260 @@ struct MethodChooser {
 //     return solvingMethod(wrapper.solver, wrapper.Translate(expressions));
 // }
 
-inline bool IsUnsat(std::unique_ptr<InternalStorage>& internal) {
+//
+// Ground solving
+//
+
+inline bool UseGrounding() {
+    // MBQI does not terminate on the flow quantifiers once data are bitvectors, finite domains are expanded instead
+    const auto& setup = GetEncodingSetup();
+    return setup.smtGroundQuantifiers || setup.smtFiniteDomain;
+}
+
+struct GroundQuery {
+    z3::solver solver; // holds the ground premise
+    std::deque<EExpr> checks; // ground counterparts of the checks, implied only if the original checks are implied
+
+    explicit GroundQuery(z3::solver& original, const std::deque<EExpr>& expressions, const std::string& category)
+            : solver(original.ctx()) {
+        MEASURE("ComputeImplied ~> GroundQuantifiers")
+        std::vector<z3::expr> formulas;
+        formulas.reserve(expressions.size() + 1);
+        formulas.push_back(MakePremise(original));
+        for (const auto& expr : expressions) formulas.push_back(!AsExpr(expr));
+        auto ground = GroundQuantifiers(formulas);
+
+        SetBudget(solver);
+        ApplySmtParams(solver, category);
+        solver.add(ground.front());
+        for (std::size_t index = 1; index < ground.size(); ++index) checks.push_back(AsEExpr(!ground.at(index)));
+    }
+};
+
+inline std::vector<bool> ComputeImpliedGround(Z3InternalStorage& storage, z3::solver& solver,
+                                              const std::deque<EExpr>& expressions) {
+    // ground queries are quantifier-free and cheap, solve them sequentially in the caller's context
+    GroundQuery query(solver, expressions, storage.category);
+    std::vector<bool> result(expressions.size(), false);
+    std::vector<std::size_t> undecided;
+    if (GetEncodingSetup().smtFilterByModel) {
+        undecided = FilterByModel(query.solver, query.checks, result);
+    } else {
+        for (std::size_t index = 0; index < expressions.size(); ++index) undecided.push_back(index);
+    }
+    for (auto index : undecided) {
+        result.at(index) = IsImpliedOrAssumeNot(IsImplied, query.solver, AsExpr(query.checks.at(index)));
+    }
+    return result;
+}
+
+
+//
+// Preprocessing
+//
+
+inline bool UsePreprocessing() {
+    return GetEncodingSetup().smtPreprocess;
+}
+
+struct PreprocessedQuery {
+    z3::solver solver; // holds the preprocessed premise, shared by all checks of a batch and the worker pool
+    std::deque<EExpr> checks; // checks with the premise's aliases eliminated
+
+    explicit PreprocessedQuery(z3::solver& original, const std::deque<EExpr>& expressions, const std::string& category)
+            : solver(original.ctx()) {
+        MEASURE("ComputeImplied ~> Preprocess")
+        auto preprocessed = Preprocess(MakePremise(original), GetEncodingSetup().smtPreprocessTactics);
+        SetBudget(solver);
+        ApplySmtParams(solver, category);
+        solver.add(preprocessed.premise);
+        for (const auto& expr : expressions) checks.push_back(AsEExpr(preprocessed.Apply(AsExpr(expr))));
+    }
+};
+
+
+//
+// Presolving
+//
+
+inline bool UsePresolving() {
+    return GetEncodingSetup().smtPresolve;
+}
+
+inline bool AreEqual(const z3::expr_vector& vector, const z3::expr_vector& other) {
+    if (vector.size() != other.size()) return false;
+    for (unsigned index = 0; index < vector.size(); ++index) {
+        if (!z3::eq(vector[(int) index], other[(int) index])) return false;
+    }
+    return true;
+}
+
+inline const StackPresolver& GetPresolver(Z3InternalStorage& storage) {
+    // the premise rarely changes between queries, e.g., across the checks of a batch or consecutive 'Implies';
+    // comparing the assertions themselves avoids rebuilding the premise for that, see 'MakePremise'
+    auto assertions = storage.solver.assertions();
+    if (storage.presolver && AreEqual(assertions, storage.presolverAssertions)) return *storage.presolver;
+
+    // selector guards may have changed only, they do not affect the premise
+    auto premise = MakePremise(storage.solver);
+    if (!storage.presolver || !z3::eq(premise, storage.presolver->GetPremise())) {
+        MEASURE("ComputeImplied ~> Presolve")
+        storage.presolver = std::make_unique<StackPresolver>(premise);
+    }
+    storage.presolverAssertions = assertions;
+    return *storage.presolver;
+}
+
+inline std::vector<std::size_t> FilterByPresolver(Z3InternalStorage& storage, const std::deque<EExpr>& expressions,
+                                                  std::vector<bool>& result) {
+    MEASURE("ComputeImplied ~> FilterByPresolver")
+    const auto& presolver = GetPresolver(storage);
+    std::vector<std::size_t> undecided;
+    for (std::size_t index = 0; index < expressions.size(); ++index) {
+        if (presolver.IsImplied(AsExpr(expressions.at(index)))) result.at(index) = true;
+        else undecided.push_back(index);
+    }
+    return undecided;
+}
+
+
+//
+// Dispatch
+//
+
+template<typename F>
+inline void SolveUndecided(const std::deque<EExpr>& expressions, const std::vector<std::size_t>& undecided,
+                           std::vector<bool>& result, const F& solve) {
+    if (undecided.empty()) return;
+    std::deque<EExpr> remaining;
+    for (auto index : undecided) remaining.push_back(expressions.at(index));
+    auto implied = solve(remaining);
+    for (std::size_t index = 0; index < undecided.size(); ++index) result.at(undecided.at(index)) = implied.at(index);
+}
+
+inline std::optional<bool> IsImpliedWithBackend(z3::solver& solver, const z3::expr& expr, SmtBackend backend) {
+    if (backend == SmtBackend::Z3) return std::nullopt;
+    return ComputeImpliedWithCvc5(MakePremise(solver), { AsEExpr(expr) }).front();
+}
+
+inline bool IsUnsat(std::unique_ptr<InternalStorage>& internal, SmtBackend backend) {
     auto& solver = AsSolver(internal);
+    auto falseExpr = solver.ctx().bool_val(false);
+    if (UsePresolving() && GetPresolver(AsInternal(internal)).IsImplied(falseExpr)) return true;
+    if (auto result = IsImpliedWithBackend(solver, falseExpr, backend)) return *result;
+    if (UseGrounding()) {
+        GroundQuery query(solver, {}, AsInternal(internal).category);
+        return IsUnsat(query.solver);
+    }
+    if (UseSelectors()) return IsUnsatNoScope(solver);
     solver.push();
     auto result = IsUnsat(solver);
     solver.pop();
     return result;
 }
 
-inline bool IsImplied(std::unique_ptr<InternalStorage>& internal, const EExpr& expression) {
+inline bool IsImplied(std::unique_ptr<InternalStorage>& internal, const EExpr& expression, SmtBackend backend) {
     auto& solver = AsSolver(internal);
+    if (UsePresolving() && GetPresolver(AsInternal(internal)).IsImplied(AsExpr(expression))) return true;
+    if (auto result = IsImpliedWithBackend(solver, AsExpr(expression), backend)) return *result;
+    if (UseGrounding()) {
+        GroundQuery query(solver, { expression }, AsInternal(internal).category);
+        return IsImplied(query.solver, AsExpr(query.checks.front()));
+    }
+    if (UseSelectors()) return IsImpliedUnderSelector(solver, AsExpr(expression));
     solver.push();
     auto result = IsImplied(solver, AsExpr(expression));
     solver.pop();
     return result;
 }
 
-inline std::vector<bool> ComputeImplied(std::unique_ptr<InternalStorage>& internal, const std::deque<EExpr>& expressions) {
-    auto& solver = AsSolver(internal);
+inline std::vector<bool> ComputeImpliedWithMethod(Z3InternalStorage& storage, z3::solver& solver,
+                                                   const std::deque<EExpr>& expressions) {
+    switch (GetEncodingSetup().smtMethod) {
+        // selectors are retired after use and 'FindModel' scopes its queries, no need to scope the batch
+        case SmtMethod::ASSUMPTIONS: return ComputeImpliedUnderSelectors(storage, solver, expressions);
+        case SmtMethod::BACKBONE: return ComputeImpliedByBackbone(solver, expressions);
+        case SmtMethod::PUSH_POP: case SmtMethod::ADAPTIVE: break;
+    }
     solver.push();
-    auto result = solvingMethod(solver, expressions);
+    auto result = GetEncodingSetup().smtMethod == SmtMethod::ADAPTIVE ? solvingMethod(solver, expressions)
+                                                                      : ComputeImpliedOneAtATime(storage, solver, expressions);
     solver.pop();
     return result;
 }
 
+inline std::vector<bool> ComputeImplied(Z3InternalStorage& storage, z3::solver& solver,
+                                        const std::deque<EExpr>& expressions) {
+    if (UseGrounding()) return ComputeImpliedGround(storage, solver, expressions);
+    if (!GetEncodingSetup().smtFilterByModel) return ComputeImpliedWithMethod(storage, solver, expressions);
+
+    std::vector<bool> result(expressions.size(), false);
+    auto undecided = FilterByModel(solver, expressions, result);
+    SolveUndecided(expressions, undecided, result, [&storage, &solver](const auto& remaining){
+        return ComputeImpliedWithMethod(storage, solver, remaining);
+    });
+    return result;
+}
+
+inline std::vector<bool> ComputeImpliedWithZ3(Z3InternalStorage& storage, const std::deque<EExpr>& expressions) {
+    if (!UsePreprocessing()) return ComputeImplied(storage, storage.solver, expressions);
+    PreprocessedQuery query(storage.solver, expressions, storage.category);
+    return ComputeImplied(storage, query.solver, query.checks);
+}
+
+inline std::vector<bool> ComputeImpliedWithBackend(Z3InternalStorage& storage, const std::deque<EExpr>& expressions,
+                                                    SmtBackend backend) {
+    if (backend == SmtBackend::Z3) return ComputeImpliedWithZ3(storage, expressions);
+
+    // checks the backend did not decide are passed on to Z3
+    std::vector<bool> result(expressions.size(), false);
+    std::vector<std::size_t> undecided;
+    auto answers = ComputeImpliedWithCvc5(MakePremise(storage.solver), expressions);
+    for (std::size_t index = 0; index < answers.size(); ++index) {
+        if (answers.at(index)) result.at(index) = *answers.at(index);
+        else undecided.push_back(index);
+    }
+    SolveUndecided(expressions, undecided, result, [&storage](const auto& remaining){
+        return ComputeImpliedWithZ3(storage, remaining);
+    });
+    return result;
+}
+
+inline std::vector<bool> ComputeImplied(std::unique_ptr<InternalStorage>& internal, const std::deque<EExpr>& expressions,
+                                        SmtBackend backend) {
+    auto& storage = AsInternal(internal);
+    if (!UsePresolving()) return ComputeImpliedWithBackend(storage, expressions, backend);
+
+    std::vector<bool> result(expressions.size(), false);
+    auto undecided = FilterByPresolver(storage, expressions, result);
+    SolveUndecided(expressions, undecided, result, [&storage, backend](const auto& remaining){
+        return ComputeImpliedWithBackend(storage, remaining, backend);
+    });
+    return result;
+}
+
+
+template<typename F>
+inline std::vector<bool> Recorded(CorpusEntry::Kind kind, const std::string& category,
+                                  std::unique_ptr<InternalStorage>& internal, const std::deque<EExpr>& checks,
+                                  const F& solve) {
+    if (!IsRecordingQueries()) return solve();
+    auto begin = std::chrono::steady_clock::now();
+    auto result = solve();
+    auto end = std::chrono::steady_clock::now();
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
+    RecordQuery(kind, category, AsSolver(internal), checks, result, time);
+    return result;
+}
+
 
 void Encoding::Check() {
     MEASURE("Encoding::Check")
     assert(checks_premise.size() == checks_callback.size());
     if (checks_premise.empty()) return;
-    auto implied = ComputeImplied(internal, checks_premise);
+    auto implied = Recorded(CorpusEntry::CHECK, category, internal, checks_premise, [this](){
+        return ComputeImplied(internal, checks_premise, GetBackend(category));
+    });
     for (std::size_t index = 0; index < implied.size(); ++index) {
         checks_callback.at(index)(implied.at(index));
     }
@@ -352,16 +757,125 @@ void Encoding::Check() {
     checks_callback.clear();
 }
 
+static constexpr std::size_t MAX_SPARE_STORAGES = 8;
+
+struct {
+    // creating contexts is expensive, batches recycle the storages of their predecessors
+    std::mutex mutex;
+    std::deque<std::unique_ptr<InternalStorage>> storages;
+} spareStorages;
+
+inline std::unique_ptr<InternalStorage> AcquireSpareStorage() {
+    std::lock_guard guard(spareStorages.mutex);
+    if (spareStorages.storages.empty()) return std::make_unique<Z3InternalStorage>();
+    auto result = std::move(spareStorages.storages.back());
+    spareStorages.storages.pop_back();
+    return result;
+}
+
+inline void ReleaseSpareStorage(std::unique_ptr<InternalStorage> internal) {
+    // resetting a solver keeps its parameters, start over with a fresh one
+    auto& storage = AsInternal(internal);
+    storage.solver = z3::solver(storage.context);
+    storage.category.clear();
+    SetBudget(storage.solver);
+    std::lock_guard guard(spareStorages.mutex);
+    if (spareStorages.storages.size() >= MAX_SPARE_STORAGES) return;
+    spareStorages.storages.push_back(std::move(internal));
+}
+
+struct AsyncBatch {
+    std::unique_ptr<InternalStorage> internal; // owned by the solving service once submitted
+    std::deque<EExpr> checks;
+    std::string category;
+
+    explicit AsyncBatch(z3::solver& solver, const std::deque<EExpr>& expressions, std::string category)
+            : internal(AcquireSpareStorage()), category(std::move(category)) {
+        MEASURE("Encoding::CheckAsync ~> Translate")
+        auto& storage = AsInternal(internal);
+        storage.category = this->category;
+        ApplySmtParams(storage.solver, storage.category);
+        storage.solver.add(Translate(MakePremise(solver), solver.ctx(), storage.context));
+        for (const auto& expr : expressions) {
+            checks.push_back(AsEExpr(Translate(AsExpr(expr), solver.ctx(), storage.context)));
+        }
+    }
+
+    ~AsyncBatch() {
+        // expressions must not outlive their context
+        checks.clear();
+        ReleaseSpareStorage(std::move(internal));
+    }
+
+    std::vector<bool> Solve() {
+        return Recorded(CorpusEntry::CHECK, category, internal, checks, [this](){
+            return ComputeImplied(internal, checks, GetBackend(category));
+        });
+    }
+};
+
+CheckHandle Encoding::CheckAsync() {
+    MEASURE("Encoding::CheckAsync")
+    assert(checks_premise.size() == checks_callback.size());
+    CheckHandle handle;
+    if (checks_premise.empty()) return handle;
+    if (GetEncodingSetup().smtAsync) {
+        // the batch gets a context of its own, the encoding remains usable while the batch is solved
+        auto batch = std::make_shared<AsyncBatch>(AsSolver(internal), checks_premise, category);
+        handle.result = SolvingService::Get().Submit([batch](){ return batch->Solve(); });
+    } else {
+        SolvingService::Task task([this](){
+            return Recorded(CorpusEntry::CHECK, category, internal, checks_premise, [this](){
+                return ComputeImplied(internal, checks_premise, GetBackend(category));
+            });
+        });
+        handle.result = task.get_future();
+        task();
+    }
+    handle.callbacks = std::move(checks_callback);
+    checks_premise.clear();
+    checks_callback.clear();
+    return handle;
+}
+
+bool CheckHandle::IsReady() const {
+    return !result.valid() || result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void CheckHandle::Join() {
+    if (!result.valid()) return;
+    auto implied = result.get();
+    auto pending = std::move(callbacks);
+    callbacks.clear();
+    for (std::size_t index = 0; index < implied.size(); ++index) {
+        pending.at(index)(implied.at(index));
+    }
+}
+
 bool Encoding::Implies(const EExpr& expr) {
     MEASURE("Encoding::Implies")
-    auto result = IsImplied(internal, expr);
-    return result;
+    try {
+        auto result = Recorded(CorpusEntry::IMPLIES, category, internal, { expr }, [this, &expr](){
+            return std::vector<bool>{ IsImplied(internal, expr, GetBackend(category)) };
+        });
+        return result.front();
+    } catch (const SolvingFailure& err) {
+        ++statistics.failed;
+        throw;
+    }
 }
 
 bool Encoding::ImpliesFalse() {
     MEASURE("Encoding::ImpliesFalse")
-    auto result = IsUnsat(internal);
-    return result;
+    try {
+        auto result = Recorded(CorpusEntry::UNSAT, category, internal, {}, [this](){
+            return std::vector<bool>{ IsUnsat(internal, GetBackend(category)) };
+        });
+        return result.front();
+    } catch (const SolvingFailure& err) {
+        ++statistics.failed;
+        throw;
+    }
 }
 
 bool Encoding::Implies(const Formula& formula) {
@@ -381,7 +895,7 @@ std::set<const SymbolDeclaration*> Encoding::ComputeNonNull(std::set<const Symbo
 
     std::deque<EExpr> expressions;
     for (const auto* elem : symbols) expressions.push_back(EncodeIsNonNull(*elem));
-    auto implied = ComputeImplied(internal, expressions);
+    auto implied = ComputeImplied(internal, expressions, GetBackend(category));
     
     auto sym = symbols.begin();
     for (bool isNonNull : implied) {
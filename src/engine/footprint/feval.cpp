@@ -55,6 +55,7 @@ using ExtensionFunction = std::function<EdgeSet(Encoding&, const FlowConstraint&
 
 std::optional<NodeSet> ComputeFixedPoint(const FlowConstraint& graph, const ExtensionFunction& getFootprintExtension) {
     Encoding encoding(*graph.context);
+    encoding.SetCategory("footprint");
     auto diff = GetDiff(graph);
     auto footprint = diff;
     while (true) {
@@ -4,6 +4,7 @@
 #include "logics/util.hpp"
 #include "util/shortcuts.hpp"
 #include "util/timer.hpp"
+#include "util/parallel.hpp"
 #include "test.hpp"
 
 using namespace plankton;
@@ -50,7 +51,7 @@ void ProofGenerator::GenerateProof() {
             return;
         }
 
-        macroPostTable.clear();
+        InvalidateMacroPosts();
         infoPrefix.Pop();
     }
     throw std::logic_error("Aborting: proof does not seem to stabilize."); // TODO: remove / better error handling
@@ -58,8 +59,39 @@ void ProofGenerator::GenerateProof() {
 
 void ProofGenerator::Visit([[maybe_unused]] const Program& object) {
     assert(&object == &program);
+
+    // functions whose footprint the new effects miss would be verified as before, their effects are already known
+    std::vector<const Function*> functions;
     for (const auto& function : program.apiFunctions) {
-        HandleInterfaceFunction(*function);
+        if (IsAffectedByNewInterference(*function)) functions.push_back(function.get());
+        else INFO(infoPrefix << "Skipping function '" << function->name << "', it is unaffected by the new effects." << std::endl)
+    }
+
+    auto threads = plankton::GetConcurrency(setup->proofThreadCount);
+    if (threads <= 1 || functions.size() <= 1) {
+        for (const auto* function : functions) {
+            HandleInterfaceFunction(*function);
+        }
+        return;
+    }
+
+    // with the interference fixed, functions are independent: they only add to 'newInterference'
+    std::vector<std::unique_ptr<ProofGenerator>> workers;
+    workers.reserve(functions.size());
+    for (std::size_t index = 0; index < functions.size(); ++index) workers.push_back(MakeWorker());
+    plankton::ParallelFor(functions.size(), threads, [&functions, &workers](std::size_t index) {
+        auto& worker = *workers.at(index);
+        FootprintRedirect redirect(worker.footprintBuffer);
+        worker.HandleInterfaceFunction(*functions.at(index));
+    });
+
+    // merge in program order, independent of scheduling
+    for (std::size_t index = 0; index < functions.size(); ++index) {
+        auto& worker = *workers.at(index);
+        AddNewInterference(std::move(worker.newInterference));
+        AppendFootprints(worker.footprintBuffer);
+        AdoptMacroPosts(worker);
+        functionFootprints[functions.at(index)] = std::move(worker.functionFootprints.at(functions.at(index)));
     }
 }
 
@@ -167,6 +199,7 @@ void ProofGenerator::HandleInterfaceFunction(const Function& function) {
     returning.clear();
     breaking.clear();
     current.clear();
+    footprint.clear();
 
     // descent into function
     auto [init, isMaintenance] = MakeInterfaceAnnotation(program, function, solver);
@@ -183,6 +216,7 @@ void ProofGenerator::HandleInterfaceFunction(const Function& function) {
         for (auto&[annotation, command]: returning) {
             assert(command);
             if (IsFulfilled(*annotation, *command)) continue;
+            RecordFootprint(*annotation, true);
             annotation = solver.ImprovePast(std::move(annotation));
             annotation = solver.TryAddFulfillment(std::move(annotation));
             if (IsFulfilled(*annotation, *command)) continue;
@@ -193,5 +227,6 @@ void ProofGenerator::HandleInterfaceFunction(const Function& function) {
                     "Could not establish linearizability for function '" + function.name + "'."); // TODO: better error handling
         }
     }
+    functionFootprints[&function] = std::move(footprint);
     infoPrefix.Pop();
 }
@@ -1,18 +1,49 @@
 #include "engine/proof.hpp"
 
 #include "programs/util.hpp"
+#include "logics/util.hpp"
 #include "util/shortcuts.hpp"
 #include "util/log.hpp"
+#include "util/parallel.hpp"
 
 using namespace plankton;
 
 
-ProofGenerator::ProofGenerator(const Program& program, const SolverConfig& config, std::shared_ptr<EngineSetup> setup)
-        : program(program), solver(program, config, setup), setup(std::move(setup)), insideAtomic(false),
-          timePost("TIME Post"), timeJoin("TIME Join"), timeInterference("TIME Interference"),
-          timePastImprove("TIME Past improve"), timePastReduce("TIME Past reduce"),
-          timeFutureImprove("TIME Future improve"), timeFutureReduce("TIME Future reduce") {
-    futureSuggestions = plankton::SuggestFutures(program);
+struct ProofGenerator::Shared {
+    Solver solver;
+    std::deque<std::unique_ptr<FutureSuggestion>> futureSuggestions;
+    Timer timePost, timeJoin, timeInterference, timePastImprove, timePastReduce, timeFutureImprove, timeFutureReduce;
+
+    explicit Shared(const Program& program, const SolverConfig& config, std::shared_ptr<EngineSetup> setup)
+            : solver(program, config, std::move(setup)), futureSuggestions(plankton::SuggestFutures(program)),
+              timePost("TIME Post"), timeJoin("TIME Join"), timeInterference("TIME Interference"),
+              timePastImprove("TIME Past improve"), timePastReduce("TIME Past reduce"),
+              timeFutureImprove("TIME Future improve"), timeFutureReduce("TIME Future reduce") {}
+};
+
+ProofGenerator::ProofGenerator(const Program& program, const SolverConfig& config, std::shared_ptr<EngineSetup> setup_)
+        : program(program), shared(std::make_shared<Shared>(program, config, setup_)), solver(shared->solver),
+          setup(std::move(setup_)), insideAtomic(false),
+          transformerThreads(plankton::GetConcurrency(setup->proofTransformerThreadCount)),
+          futureSuggestions(shared->futureSuggestions),
+          timePost(shared->timePost), timeJoin(shared->timeJoin), timeInterference(shared->timeInterference),
+          timePastImprove(shared->timePastImprove), timePastReduce(shared->timePastReduce),
+          timeFutureImprove(shared->timeFutureImprove), timeFutureReduce(shared->timeFutureReduce) {
+}
+
+ProofGenerator::ProofGenerator(const ProofGenerator& parent)
+        : program(parent.program), shared(parent.shared), solver(shared->solver), setup(parent.setup),
+          insideAtomic(false), transformerThreads(parent.transformerThreads),
+          futureSuggestions(shared->futureSuggestions), infoPrefix(parent.infoPrefix),
+          timePost(shared->timePost), timeJoin(shared->timeJoin), timeInterference(shared->timeInterference),
+          timePastImprove(shared->timePastImprove), timePastReduce(shared->timePastReduce),
+          timeFutureImprove(shared->timeFutureImprove), timeFutureReduce(shared->timeFutureReduce) {
+    AdoptMacroPosts(parent);
+}
+
+std::unique_ptr<ProofGenerator> ProofGenerator::MakeWorker() const {
+    // the worker starts from a copy of the macro table, its new posts are adopted back after the iteration
+    return std::unique_ptr<ProofGenerator>(new ProofGenerator(*this));
 }
 
 void ProofGenerator::LeaveAllNestedScopes(const AstNode& node) {
@@ -79,40 +110,111 @@ void ProofGenerator::PruneReturning() {
     plankton::RemoveIf(returning, [](const auto& elem) { return !elem.first; });
 }
 
+static constexpr std::size_t MIN_PARALLEL_DISJUNCTS = 2; // smaller annotation sets are transformed sequentially
+
 void ProofGenerator::ApplyTransformer(const std::function<std::unique_ptr<Annotation>(std::unique_ptr<Annotation>)>& transformer) {
     if (current.empty()) return;
-    for (auto& annotation : current) {
-        annotation = transformer(std::move(annotation));
+    if (current.size() < MIN_PARALLEL_DISJUNCTS) {
+        for (auto& annotation : current) {
+            annotation = transformer(std::move(annotation));
+        }
+        return;
     }
+    std::vector<std::stringstream> footprints(current.size());
+    plankton::ParallelFor(current.size(), transformerThreads, [this, &transformer, &footprints](std::size_t index) {
+        FootprintRedirect redirect(footprints.at(index));
+        auto& annotation = current.at(index);
+        annotation = transformer(std::move(annotation));
+    });
+    for (const auto& buffer : footprints) AppendFootprints(buffer);
 }
 
 void ProofGenerator::ApplyTransformer(const std::function<PostImage(std::unique_ptr<Annotation>)>& transformer) {
     if (current.empty()) return;
+    if (current.size() < MIN_PARALLEL_DISJUNCTS) {
+        decltype(current) newCurrent;
+        for (auto& annotation : current) {
+            auto postImage = transformer(std::move(annotation));
+            MoveInto(std::move(postImage.annotations), newCurrent);
+            AddNewInterference(std::move(postImage.effects));
+        }
+        current = std::move(newCurrent);
+        return;
+    }
+    std::vector<PostImage> postImages(current.size());
+    std::vector<std::stringstream> footprints(current.size());
+    plankton::ParallelFor(current.size(), transformerThreads, [this, &transformer, &postImages, &footprints](std::size_t index) {
+        FootprintRedirect redirect(footprints.at(index));
+        postImages.at(index) = transformer(std::move(current.at(index)));
+    });
+
+    // gather in the order of 'current', independent of scheduling
     decltype(current) newCurrent;
-    for (auto& annotation : current) {
-        auto postImage = transformer(std::move(annotation));
+    for (std::size_t index = 0; index < postImages.size(); ++index) {
+        auto& postImage = postImages.at(index);
         MoveInto(std::move(postImage.annotations), newCurrent);
         AddNewInterference(std::move(postImage.effects));
+        AppendFootprints(footprints.at(index));
     }
     current = std::move(newCurrent);
 }
 
+void ProofGenerator::AppendFootprints(const std::stringstream& buffer) {
+    // empty unless the footprint export is enabled
+    if (!setup->footprints.is_open()) return;
+    plankton::GetFootprintStream(*setup) << buffer.str();
+}
+
 void ProofGenerator::AddNewInterference(std::deque<std::unique_ptr<HeapEffect>> effects) {
     MoveInto(effects, newInterference);
 }
 
 bool ProofGenerator::ConsolidateNewInterference() {
     INFO(infoPrefix << "Checking for new effects. (" << newInterference.size() << ") " << std::endl)
+    // the solver adds a subset of the effects and prunes only old effects that are implied by new ones, which requires
+    // them to be of the same type; hence, the interference changes at most for the types of 'newInterference'
+    newInterferenceTypes = Footprint();
+    for (const auto& effect : newInterference) newInterferenceTypes->insert(&effect->pre->node->GetType());
     auto result = solver.AddInterference(std::move(newInterference));
     newInterference.clear();
     return result;
 }
 
+void ProofGenerator::RecordFootprint(const Annotation& annotation, bool improvesPast) {
+    // stability considers only effects on memory of the same type, see 'Solver::MakeInterferenceStable';
+    // past interpolation considers all effects, unless there are no past predicates, see 'Solver::ImprovePast'
+    if (improvesPast && !annotation.past.empty()) footprint.insert(ANY_TYPE);
+    for (const auto* memory : plankton::Collect<SharedMemoryCore>(annotation)) {
+        footprint.insert(&memory->node->GetType());
+    }
+}
+
+void ProofGenerator::RecordFootprint(bool improvesPast) {
+    for (const auto& annotation : current) RecordFootprint(*annotation, improvesPast);
+}
+
+bool ProofGenerator::IsAffectedByNewInterference(const Footprint& footprint_) const {
+    if (!newInterferenceTypes) return true;
+    if (newInterferenceTypes->empty()) return false;
+    if (plankton::Membership(footprint_, ANY_TYPE)) return true;
+    return plankton::NonEmptyIntersection(footprint_, newInterferenceTypes.value());
+}
+
+bool ProofGenerator::IsAffectedByNewInterference(const Function& function) const {
+    // A function is verified anew unless no effect changed for the types in its footprint since its latest
+    // verification. Skipped functions keep their footprint, so that holds inductively across iterations. Their proof
+    // consults the same interference as before, hence it is the same and its effects are already part of it.
+    auto find = functionFootprints.find(&function);
+    if (find == functionFootprints.end()) return true;
+    return IsAffectedByNewInterference(find->second);
+}
+
 void ProofGenerator::MakeInterferenceStable(const Statement& after) {
     INFO(infoPrefix << "Applying interference." << INFO_SIZE << std::endl)
     if (insideAtomic) return;
     if (current.empty()) return;
     if (plankton::IsRightMover(after)) return;
+    RecordFootprint(true);
     ApplyTransformer([this](auto annotation){
         // TODO: improve future?
         {
@@ -151,10 +253,12 @@ void ProofGenerator::JoinCurrent() {
 }
 void ProofGenerator::ImproveCurrentTime() {
     INFO(infoPrefix << "Improving time predicates." << INFO_SIZE << std::endl)
+    RecordFootprint(true);
     ApplyTransformer([this](auto annotation) {
         auto measure = timePastImprove.Measure();
         return solver.ImprovePast(std::move(annotation));
     });
+    RecordFootprint(false);
     for (const auto& future : futureSuggestions) {
         ApplyTransformer([this, &future](auto annotation) {
             auto measure = timeFutureImprove.Measure();
@@ -140,24 +140,68 @@ inline void CleanAnnotation(Annotation& annotation) {
     plankton::RemoveIf(annotation.past, containsPruned);
 }
 
+template<typename T>
+inline const T* FindSyntacticallyEqual(const std::deque<T>& entries, const std::unordered_multimap<std::size_t, std::size_t>& index,
+                                       const Annotation& pre) {
+    auto range = index.equal_range(plankton::SyntacticalHash(pre));
+    for (auto it = range.first; it != range.second; ++it) {
+        const auto& entry = entries.at(it->second);
+        if (plankton::SyntacticalEqual(*entry.pre, pre)) return &entry;
+    }
+    return nullptr;
+}
+
 inline std::optional<ProofGenerator::AnnotationList>
 ProofGenerator::LookupMacroPost(const Macro& macro, const Annotation& annotation) {
     auto find = macroPostTable.find(&macro.Func());
-    if (find != macroPostTable.end()) {
-        for (const auto&[pre, post]: find->second) {
-            if (!solver.Implies(annotation, *pre)) continue;
-            return plankton::CopyAll(post);
+    if (find == macroPostTable.end()) return std::nullopt;
+    const auto& table = find->second;
+
+    // stored pres are cleaned, cleaning weakens, so a syntactic match is implied without solving
+    auto cleaned = plankton::Copy(annotation);
+    CleanAnnotation(*cleaned);
+    const TabulatedPost* hit = FindSyntacticallyEqual(table.entries, table.index, *cleaned);
+    if (!hit) {
+        for (const auto& entry : table.entries) {
+            if (!solver.Implies(annotation, *entry.pre)) continue;
+            hit = &entry;
+            break;
         }
     }
-    return std::nullopt;
+
+    if (!hit) return std::nullopt;
+    plankton::InsertInto(hit->footprint, footprint); // the post depends on the footprint it was computed with
+    return plankton::CopyAll(hit->post);
 }
 
-inline void
-ProofGenerator::AddMacroPost(const Macro& macro, const Annotation& pre, const ProofGenerator::AnnotationList& post) {
+void ProofGenerator::AddMacroPost(const Function& macro, const Annotation& pre, const ProofGenerator::AnnotationList& post,
+                                  const Footprint& postFootprint) {
     // DEBUG("%% storing macro post: " << pre << " >>>>> ")
     // for (const auto& elem : post) DEBUG(*elem)
     // DEBUG(std::endl)
-    macroPostTable[&macro.Func()].emplace_back(plankton::Copy(pre), plankton::CopyAll(post));
+    auto& table = macroPostTable[&macro];
+    if (FindSyntacticallyEqual(table.entries, table.index, pre)) return;
+    table.index.emplace(plankton::SyntacticalHash(pre), table.entries.size());
+    table.entries.push_back({ plankton::Copy(pre), plankton::CopyAll(post), postFootprint });
+}
+
+void ProofGenerator::AdoptMacroPosts(const ProofGenerator& worker) {
+    for (const auto& [macro, table] : worker.macroPostTable) {
+        for (const auto& entry : table.entries) AddMacroPost(*macro, *entry.pre, entry.post, entry.footprint);
+    }
+}
+
+void ProofGenerator::InvalidateMacroPosts() {
+    assert(newInterferenceTypes);
+    for (auto& [macro, table] : macroPostTable) {
+        auto entries = std::move(table.entries);
+        table = MacroPostTable();
+        for (auto& entry : entries) {
+            if (IsAffectedByNewInterference(entry.footprint)) continue;
+            table.index.emplace(plankton::SyntacticalHash(*entry.pre), table.entries.size());
+            table.entries.push_back(std::move(entry));
+        }
+    }
 }
 
 void ProofGenerator::HandleMacroLazy(const Macro& cmd) {
@@ -178,10 +222,13 @@ void ProofGenerator::HandleMacroLazy(const Macro& cmd) {
     if (!current.empty()) {
         for (auto& elem : current) CleanAnnotation(*elem);
         auto pre = plankton::CopyAll(current);
+        auto outerFootprint = std::move(footprint);
+        footprint.clear();
         cmd.Func().Accept(*this);
         HandleMacroEpilog(cmd);
         // for (auto& elem : current) CleanAnnotation(*elem);
-        for (const auto& elem : pre) AddMacroPost(cmd, *elem, current);
+        for (const auto& elem : pre) AddMacroPost(cmd.Func(), *elem, current, footprint);
+        plankton::InsertInto(std::move(outerFootprint), footprint);
     }
 
     plankton::MoveInto(std::move(post), current);
@@ -26,6 +26,7 @@ struct FulfillmentFinder {
     explicit FulfillmentFinder(const Annotation& annotation, const SolverConfig& config)
             : config(config), factory(annotation), encoding(*annotation.now, config),
               obligations(plankton::Collect<ObligationAxiom>(*annotation.now)) {
+        encoding.SetCategory("fulfillment");
     }
     
     void Handle(const Formula& formula) {
@@ -100,6 +100,7 @@ void Solver::ReduceFuture(Annotation& annotation) const {
     annotation.future = std::move(futures);
 
     Encoding encoding(*annotation.now);
+    encoding.SetCategory("future");
     for (auto& future : annotation.future) {
         if (!future) continue;
         if (plankton::EmptyIntersection(plankton::Collect<SymbolDeclaration>(*future), useful)) {
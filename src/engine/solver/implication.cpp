@@ -76,7 +76,7 @@ struct AxiomAnalyser : public DefaultLogicVisitor {
 };
 
 inline bool IsStack(const std::unique_ptr<Formula>& object) {
-    static AxiomAnalyser analyser;
+    AxiomAnalyser analyser; // not shared, solvers may run on several threads
     return analyser.IsStack(*object);
 }
 
@@ -93,6 +93,7 @@ inline bool ResourcesMatch(const Annotation& premise, const Annotation& conclusi
 inline bool StackImplies(const Annotation& premise, const SeparatingConjunction& conclusion, const SolverConfig& config) {
     MEASURE("Solver::Implies ~> StackImplies")
     Encoding encoding(*premise.now);
+    encoding.SetCategory("implication");
     encoding.AddPremise(encoding.EncodeInvariants(*premise.now, config));
     for (const auto& past : premise.past) encoding.AddPremise(encoding.EncodeInvariants(*past->formula, config));
     return encoding.Implies(conclusion);
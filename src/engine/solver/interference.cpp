@@ -11,6 +11,8 @@ using namespace plankton;
 
 using EffectPairDeque = std::deque<std::pair<const HeapEffect*, const HeapEffect*>>;
 
+static constexpr std::size_t ASYNC_CHUNK_SIZE = 64; // effect pairs solved in the background while encoding more
+
 
 //
 // Implication among effects
@@ -39,6 +41,9 @@ inline bool UpdateSubset(const HeapEffect& premise, const HeapEffect& conclusion
 
 inline void AddEffectImplicationCheck(Encoding& encoding, const HeapEffect& premise, const HeapEffect& conclusion,
                                       std::function<void()>&& eureka) {
+    // effects on different types never imply each other, see 'EncodeMemoryEquality'
+    if (premise.pre->node->GetType() != conclusion.pre->node->GetType()) return;
+
     // give up if context contains resources
     if (!CheckContext(*premise.context) || !CheckContext(*conclusion.context)) return;
     
@@ -63,11 +68,16 @@ inline void AddEffectImplicationCheck(Encoding& encoding, const HeapEffect& prem
 inline EffectPairDeque ComputeEffectImplications(const EffectPairDeque& effectPairs) {
     EffectPairDeque result;
     Encoding encoding;
-    for (const auto& pair : effectPairs) {
+    encoding.SetCategory("effects");
+    std::deque<CheckHandle> handles;
+    for (std::size_t index = 0; index < effectPairs.size(); ++index) {
+        const auto& pair = effectPairs.at(index);
         auto eureka = [&result, pair]() { result.push_back(pair); };
         AddEffectImplicationCheck(encoding, *pair.first, *pair.second, std::move(eureka));
+        if ((index + 1) % ASYNC_CHUNK_SIZE == 0) handles.push_back(encoding.CheckAsync());
     }
-    encoding.Check();
+    handles.push_back(encoding.CheckAsync());
+    for (auto& handle : handles) handle.Join();
     return result;
 }
 
@@ -217,6 +217,7 @@ struct AnnotationJoiner {
     
     explicit AnnotationJoiner(std::deque<std::unique_ptr<Annotation>>&& annotations_, const SolverConfig& config)
             : result(std::make_unique<Annotation>()), annotations(std::move(annotations_)), config(config) {
+        encoding.SetCategory("join");
     }
 
     std::unique_ptr<Annotation> GetResult() {
@@ -14,6 +14,7 @@ constexpr const bool INTERPOLATE_POINTERS_ONLY = true;
 
 inline Encoding MakeEncoding(const Annotation& annotation, const SolverConfig& config) {
     Encoding encoding(*annotation.now, config);
+    encoding.SetCategory("past");
     encoding.AddPremise(encoding.EncodeInvariants(*annotation.now, config));
     // encoding.AddPremise(encoding.EncodeSimpleFlowRules(*annotation.now, config));
     for (const auto& elem : annotation.past)
@@ -38,6 +38,7 @@ struct PostImageInfo {
               preObligations(plankton::Collect<ObligationAxiom>(*pre.now)),
               preFulfillments(plankton::Collect<FulfillmentAxiom>(*pre.now)) {
         assert(&pre == footprint.pre.get());
+        encoding.SetCategory("post");
         // DEBUG("** pre after footprint creation: " << pre << std::endl)
     }
     
@@ -736,7 +737,7 @@ void WriteGraphToFile(const FlowGraph& graph, const std::shared_ptr<EngineSetup>
         return encoding.Implies(InflowEmptinessAxiom(node.frameInflow, true));
     };
 
-    auto& out = setup->footprints;
+    auto& out = plankton::GetFootprintStream(*setup);
     auto rename = [](const auto& obj) -> std::string {
         std::stringstream stream;
         stream << obj;
@@ -3,6 +3,7 @@
 #include "engine/solver.hpp"
 
 #include "programs/util.hpp"
+#include "engine/encoding.hpp"
 
 using namespace plankton;
 
@@ -21,6 +22,24 @@ std::ostream& plankton::operator<<(std::ostream& out, const HeapEffect& object)
     return out;
 }
 
+inline std::ostream*& GetFootprintRedirect() {
+    thread_local std::ostream* redirect = nullptr;
+    return redirect;
+}
+
+FootprintRedirect::FootprintRedirect(std::ostream& buffer) : previous(GetFootprintRedirect()) {
+    GetFootprintRedirect() = &buffer;
+}
+
+FootprintRedirect::~FootprintRedirect() {
+    GetFootprintRedirect() = previous;
+}
+
+std::ostream& plankton::GetFootprintStream(EngineSetup& setup) {
+    if (auto* redirect = GetFootprintRedirect()) return *redirect;
+    return setup.footprints;
+}
+
 PostImage::PostImage() = default;
 
 PostImage::PostImage(std::unique_ptr<Annotation> post) {
@@ -95,4 +114,7 @@ Solver::Solver(const Program& program, const SolverConfig& config, std::shared_p
     // sanity check
     AssumptionChecker checker;
     program.Accept(checker);
+
+    // smt solving
+    plankton::SetupEncoding(this->setup);
 }
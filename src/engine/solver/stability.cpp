@@ -9,6 +9,8 @@
 
 using namespace plankton;
 
+static constexpr std::size_t ASYNC_CHUNK_SIZE = 64; // checks solved in the background while encoding more
+
 
 struct InterferenceInfo {
     SymbolFactory factory;
@@ -51,15 +53,23 @@ struct InterferenceInfo {
 
     inline void Compute() {
         Encoding encoding;
+        encoding.SetCategory("stability");
         encoding.AddPremise(*annotation->now);
         encoding.AddPremise(encoding.TidSelf() != encoding.TidSome());
         auto resources = plankton::CollectMutable<SharedMemoryCore>(*annotation->now);
+        std::deque<CheckHandle> handles;
+        std::size_t pending = 0;
         for (auto* memory : resources) {
             for (const auto& effect : interference) {
                 Handle(*memory, *effect, encoding);
             }
+            pending += interference.size();
+            if (pending < ASYNC_CHUNK_SIZE) continue;
+            handles.push_back(encoding.CheckAsync());
+            pending = 0;
         }
-        encoding.Check();
+        handles.push_back(encoding.CheckAsync());
+        for (auto& handle : handles) handle.Join();
     }
 
     inline bool IsStackFormula(const Formula& formula) {
@@ -78,6 +88,7 @@ struct InterferenceInfo {
         std::deque<std::unique_ptr<SharedMemoryCore>> oldMemory;
         std::deque<std::deque<std::unique_ptr<Axiom>>> candidateList;
         Encoding encoding;
+        encoding.SetCategory("stability");
 
         for (const auto& [axiom, effects] : stabilityUpdates) {
             if (effects.empty()) continue;
@@ -6,5 +6,7 @@ using namespace plankton;
 
 
 bool Solver::IsUnsatisfiable(const Annotation& annotation) const {
-    return Encoding(*annotation.now, config).ImpliesFalse();
+    Encoding encoding(*annotation.now, config);
+    encoding.SetCategory("unsat");
+    return encoding.ImpliesFalse();
 }
@@ -42,6 +42,7 @@ std::unique_ptr<Annotation> Solver::Widen(std::unique_ptr<Annotation> annotation
 
     // stack
     Encoding encoding;
+    encoding.SetCategory("widen");
     encoding.AddPremise(encoding.EncodeFormulaWithKnowledge(*annotation->now, config));
     plankton::ExtendStack(*result, encoding, ExtensionPolicy::FAST);
 
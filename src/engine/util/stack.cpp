@@ -159,27 +159,39 @@ void plankton::ExtendStack(Annotation& annotation, Encoding& encoding, Extension
     // Generator generator(policy);
     // generator.AddSymbolsFrom(annotation);
     // auto candidates = generator.Generate();
+    auto addChecks = [&encoding,&annotation](auto& candidates) {
+        for (auto& candidate : candidates) {
+            encoding.AddCheck(encoding.Encode(*candidate), [&candidate,&annotation](bool holds){
+                assert(candidate);
+                if (holds) annotation.Conjoin(std::move(candidate));
+            });
+        }
+    };
+
+    // solve the candidates for 'now' while generating those relating 'now' to the past and future
     auto candidates = plankton::MakeStackCandidates(*annotation.now, policy);
+    addChecks(candidates);
+    auto handle = encoding.CheckAsync();
+
+    std::deque<std::unique_ptr<Axiom>> relatedCandidates;
     for (const auto& past : annotation.past) {
         auto pastCandidates = plankton::MakeStackCandidates(*annotation.now, *past, policy);
-        plankton::MoveInto(std::move(pastCandidates), candidates);
+        plankton::MoveInto(std::move(pastCandidates), relatedCandidates);
     }
     for (const auto& future : annotation.future) {
         auto futureCandidates = plankton::MakeStackCandidates(*annotation.now, *future, policy);
-        plankton::MoveInto(std::move(futureCandidates), candidates);
+        plankton::MoveInto(std::move(futureCandidates), relatedCandidates);
     }
-    // DEBUG("plankton::ExtendStack for " << candidates.size() << " candidates" << std::endl)
-    
-    for (auto& candidate : candidates) {
-        encoding.AddCheck(encoding.Encode(*candidate), [&candidate,&annotation](bool holds){
-            assert(candidate);
-            if (holds) annotation.Conjoin(std::move(candidate));
-        });
-    }
-    encoding.Check();
+    // DEBUG("plankton::ExtendStack for " << candidates.size() + relatedCandidates.size() << " candidates" << std::endl)
+
+    addChecks(relatedCandidates);
+    auto relatedHandle = encoding.CheckAsync();
+    handle.Join();
+    relatedHandle.Join();
 }
 
 void plankton::ExtendStack(Annotation& annotation, const SolverConfig& config, ExtensionPolicy policy) {
     Encoding encoding(*annotation.now, config);
+    encoding.SetCategory("stack");
     plankton::ExtendStack(annotation, encoding, policy);
 }
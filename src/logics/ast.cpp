@@ -1,5 +1,6 @@
 #include "logics/ast.hpp"
 
+#include <mutex>
 #include <utility>
 
 #include "logics/util.hpp"
@@ -45,8 +46,8 @@ inline std::string MakeName(const Type& type, Order order, std::size_t counter)
     return result;
 }
 
-SymbolDeclaration::SymbolDeclaration(std::string name, const Type& type, Order order)
-        : name(std::move(name)), type(type), order(order) {
+SymbolDeclaration::SymbolDeclaration(std::string name, const Type& type, Order order, std::size_t id)
+        : name(std::move(name)), type(type), order(order), id(id) {
 }
 
 SymbolFactory::SymbolFactory() = default;
@@ -64,28 +65,42 @@ void SymbolFactory::Avoid(const SymbolDeclaration& avoid) {
     inUse.insert(&avoid);
 }
 
+struct SymbolPool {
+    std::mutex mutex; // symbols are shared among all factories, which may live on different threads
+    std::deque<std::unique_ptr<SymbolDeclaration>> symbols; // indexed by 'SymbolDeclaration::id'
+    std::map<std::pair<const Type*, Order>, std::deque<const SymbolDeclaration*>> symbolsOfKind;
+};
+
+inline SymbolPool& GetSymbolPool() {
+    static SymbolPool pool;
+    return pool;
+}
+
 const SymbolDeclaration& SymbolFactory::GetFresh(const Type& type, Order order) {
-    static std::deque<std::unique_ptr<SymbolDeclaration>> symbols;
-
-    // try to find existing symbol
-    // TODO: implement more efficiently
-    auto find = FindIf(symbols, [this, &type, order](const auto& elem) {
-        assert(elem);
-        return elem->type == type && elem->order == order && inUse.count(elem.get()) == 0;
-    });
-    
+    auto& pool = GetSymbolPool();
+    std::lock_guard guard(pool.mutex);
+    auto kind = std::make_pair(&type, order);
+    auto& candidates = pool.symbolsOfKind[kind];
+    auto& index = next[kind];
+
+    // try to find existing symbol, 'inUse' only grows so skipped symbols need not be revisited
+    while (index < candidates.size() && inUse.count(candidates[index]) != 0) ++index;
+
     const SymbolDeclaration* result;
-    if (find != symbols.end()) {
-        result = find->get();
+    if (index < candidates.size()) {
+        result = candidates[index];
     } else {
         // make new symbol
         assert(order == Order::FIRST || type == Type::Data());
-        symbols.emplace_back(new SymbolDeclaration(MakeName(type, order, symbols.size()), type, order));
-        result = symbols.back().get();
+        auto id = pool.symbols.size();
+        pool.symbols.emplace_back(new SymbolDeclaration(MakeName(type, order, id), type, order, id));
+        result = pool.symbols.back().get();
+        candidates.push_back(result);
     }
     
     assert(result);
     inUse.insert(result);
+    ++index;
     return *result;
 }
 
@@ -0,0 +1,90 @@
+#include "logics/util.hpp"
+
+#include <functional>
+
+using namespace plankton;
+
+
+inline std::size_t Combine(std::size_t seed, std::size_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+template<typename T>
+inline std::size_t Hash(const T& value) {
+    return std::hash<T>{}(value);
+}
+
+struct LogicHasher : public LogicVisitor {
+    std::size_t result = 0;
+
+    static std::size_t Hash(const LogicObject& object) {
+        LogicHasher hasher;
+        object.Accept(hasher);
+        return hasher.result;
+    }
+
+    inline void Tag(std::size_t tag) { result = Combine(result, tag); }
+    inline void Add(std::size_t value) { result = Combine(result, value); }
+    inline void Add(const LogicObject& object) { Add(Hash(object)); }
+
+    template<typename T>
+    inline void AddConjuncts(const T& object) {
+        Add(object.conjuncts.size());
+        for (const auto& elem : object.conjuncts) Add(*elem);
+    }
+
+    inline void AddMemory(const MemoryAxiom& object) {
+        Add(*object.node);
+        Add(*object.flow);
+        // 'SyntacticalEqual' does not compare field names, only the values of the receiver's fields
+        for (const auto& pair : object.fieldToValue) Add(*pair.second);
+    }
+
+    void Visit(const SymbolicVariable& object) override { Tag(1); Add(::Hash(&object.Decl())); }
+    void Visit(const SymbolicBool& object) override { Tag(2); Add(object.value); }
+    void Visit(const SymbolicNull& /*object*/) override { Tag(3); }
+    void Visit(const SymbolicMin& /*object*/) override { Tag(4); }
+    void Visit(const SymbolicMax& /*object*/) override { Tag(5); }
+    void Visit(const SymbolicSelfTid& /*object*/) override { Tag(6); }
+    void Visit(const SymbolicSomeTid& /*object*/) override { Tag(7); }
+    void Visit(const SymbolicUnlocked& /*object*/) override { Tag(8); }
+    void Visit(const Guard& object) override { Tag(9); Add(object.conjuncts.size()); }
+    void Visit(const Update& object) override { Tag(10); Add(object.fields.size()); }
+    void Visit(const SeparatingConjunction& object) override { Tag(11); AddConjuncts(object); }
+    void Visit(const LocalMemoryResource& object) override { Tag(12); AddMemory(object); }
+    void Visit(const SharedMemoryCore& object) override { Tag(13); AddMemory(object); }
+    void Visit(const EqualsToAxiom& object) override { Tag(14); Add(::Hash(&object.Variable())); Add(*object.value); }
+    void Visit(const StackAxiom& object) override {
+        // order independent: 'SyntacticalEqual' identifies 'a < b' and 'b > a'
+        auto lhs = Hash(*object.lhs);
+        auto rhs = Hash(*object.rhs);
+        auto straight = Combine(Combine(::Hash(static_cast<int>(object.op)), lhs), rhs);
+        auto flipped = Combine(Combine(::Hash(static_cast<int>(Symmetric(object.op))), rhs), lhs);
+        Tag(15);
+        Add(object.op == Symmetric(object.op) ? straight : straight + flipped);
+    }
+    void Visit(const InflowEmptinessAxiom& object) override { Tag(16); Add(*object.flow); Add(object.isEmpty); }
+    void Visit(const InflowContainsValueAxiom& object) override { Tag(17); Add(*object.flow); Add(*object.value); }
+    void Visit(const InflowContainsRangeAxiom& object) override {
+        Tag(18);
+        Add(*object.flow);
+        Add(*object.valueLow);
+        Add(*object.valueHigh);
+    }
+    void Visit(const ObligationAxiom& object) override { Tag(19); Add(static_cast<int>(object.spec)); Add(*object.key); }
+    void Visit(const FulfillmentAxiom& object) override { Tag(20); Add(object.returnValue); }
+    void Visit(const NonSeparatingImplication& object) override { Tag(21); Add(*object.premise); Add(*object.conclusion); }
+    void Visit(const ImplicationSet& object) override { Tag(22); AddConjuncts(object); }
+    void Visit(const PastPredicate& object) override { Tag(23); Add(*object.formula); }
+    void Visit(const FuturePredicate& object) override { Tag(24); Add(*object.guard); Add(*object.update); }
+    void Visit(const Annotation& object) override {
+        Tag(25);
+        Add(*object.now);
+        for (const auto& elem : object.past) Add(*elem);
+        for (const auto& elem : object.future) Add(*elem);
+    }
+};
+
+std::size_t plankton::SyntacticalHash(const LogicObject& object) {
+    return LogicHasher::Hash(object);
+}
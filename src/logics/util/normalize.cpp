@@ -56,16 +56,6 @@ inline std::size_t GetIncidence(const T& object) {
 // Ordering non-virtual expressions/axioms
 //
 
-static struct SymbolOrder {
-    std::map<const SymbolDeclaration*, std::size_t> symbolToIndex;
-
-    inline std::size_t Get(const SymbolDeclaration& decl) {
-        auto find = symbolToIndex.find(&decl);
-        if (find == symbolToIndex.end()) find = symbolToIndex.emplace(&decl, symbolToIndex.size()).first;
-        return find->second;
-    }
-} ordering;
-
 
 inline bool LLessLogic(const LogicObject& object, const LogicObject& other);
 inline bool LLessProgram(const Expression& object, const Expression& other);
@@ -88,7 +78,7 @@ inline bool LLess(const VariableDeclaration& decl, const VariableDeclaration& ot
 
 inline bool LLess(const SymbolDeclaration& decl, const SymbolDeclaration& other) {
     // return &decl < &other;
-    return ordering.Get(decl) < ordering.Get(other);
+    return decl.id < other.id;
 }
 
 inline bool LLess(const VariableExpression& object, const VariableExpression& other) {
@@ -383,8 +373,7 @@ inline void ApplyRenaming(Annotation& annotation) {
         void Visit(const InflowContainsValueAxiom&) override { /* do nothing */ }
         void Visit(const InflowContainsRangeAxiom&) override { /* do nothing */ }
         void Enter(const SymbolDeclaration& object) override {
-            ordering.Get(renaming(object));
-            // (void) renaming(object);
+            (void) renaming(object);
         }
     } collector;
     annotation.Accept(collector);
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef PLANKTON_TOOL_COMMON_HPP
+#define PLANKTON_TOOL_COMMON_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include "tclap/CmdLine.h"
+#include "engine/setup.hpp"
+
+namespace plankton {
+
+    struct IsRegularFileConstraint : public TCLAP::Constraint<std::string> {
+        std::string id = "path";
+        [[nodiscard]] std::string description() const override { return "path to regular file"; }
+        [[nodiscard]] std::string shortID() const override { return this->id; }
+        [[nodiscard]] bool check(const std::string& path) const override {
+            std::ifstream stream(path.c_str());
+            return stream.good();
+        }
+        explicit IsRegularFileConstraint(const std::string& more_verbose="") {
+            this->id += more_verbose;
+        }
+    };
+
+    inline const std::map<std::string, SmtMethod> SMT_METHODS = {
+            { "adaptive", SmtMethod::ADAPTIVE },
+            { "pushpop", SmtMethod::PUSH_POP },
+            { "assumptions", SmtMethod::ASSUMPTIONS },
+            { "backbone", SmtMethod::BACKBONE },
+    };
+
+    inline std::vector<std::string> GetSmtMethodNames() {
+        std::vector<std::string> result;
+        for (const auto& [name, method] : SMT_METHODS) result.push_back(name);
+        return result;
+    }
+
+    inline const std::map<std::string, SmtBackend> SMT_BACKENDS = {
+            { "z3", SmtBackend::Z3 },
+            { "cvc5", SmtBackend::CVC5 },
+    };
+
+    inline std::vector<std::string> GetSmtBackendNames() {
+        std::vector<std::string> result;
+        for (const auto& [name, backend] : SMT_BACKENDS) result.push_back(name);
+        return result;
+    }
+
+    inline std::map<std::string, SmtBackend> GetSmtBackendsByCategory(const std::vector<std::string>& assignments) {
+        std::map<std::string, SmtBackend> result;
+        for (const auto& assignment : assignments) {
+            auto split = assignment.rfind('=');
+            auto backend = split == std::string::npos ? SMT_BACKENDS.end() : SMT_BACKENDS.find(assignment.substr(split + 1));
+            if (backend == SMT_BACKENDS.end()) {
+                throw TCLAP::CmdLineParseException("expected 'category=backend', got '" + assignment + "'", "smtBackendFor");
+            }
+            result[assignment.substr(0, split)] = backend->second;
+        }
+        return result;
+    }
+
+    // number of checks answered differently, all of them if the number of checks differs
+    inline std::size_t CountMismatches(const std::vector<bool>& recorded, const std::vector<bool>& replayed) {
+        if (recorded.size() != replayed.size()) return std::max(recorded.size(), replayed.size());
+        std::size_t result = 0;
+        for (std::size_t index = 0; index < recorded.size(); ++index) {
+            if (recorded.at(index) != replayed.at(index)) ++result;
+        }
+        return result;
+    }
+
+} // namespace plankton
+
+#endif //PLANKTON_TOOL_COMMON_HPP
@@ -1,9 +1,13 @@
+#include <map>
 #include <chrono>
 #include <utility>
 #include "tclap/CmdLine.h"
+#include "common.hpp"
 #include "cfg2string.hpp"
 #include "engine/linearizability.hpp"
 #include "engine/setup.hpp"
+#include "engine/params.hpp"
+#include "engine/encoding.hpp"
 #include "parser/parse.hpp"
 #include "util/log.hpp"
 
@@ -22,24 +26,15 @@ struct CommandLineInput {
     std::shared_ptr<EngineSetup> setup = std::make_shared<EngineSetup>();
 };
 
-struct IsRegularFileConstraint : public TCLAP::Constraint<std::string> {
-    std::string id = "path";
-    [[nodiscard]] std::string description() const override { return "path to regular file"; }
-    [[nodiscard]] std::string shortID() const override { return this->id; }
-    [[nodiscard]] bool check(const std::string& path) const override {
-        std::ifstream stream(path.c_str());
-        return stream.good();
-    }
-    explicit IsRegularFileConstraint(const std::string& more_verbose="") {
-        this->id += more_verbose;
-    }
-};
-
 inline CommandLineInput Interact(int argc, char** argv) {
     CommandLineInput input;
 
     TCLAP::CmdLine cmd("PLANKTON verification tool for lock-free data structures", ' ', "1.0");
     auto isFile = std::make_unique<IsRegularFileConstraint>("_to_input");
+    auto smtMethodNames = GetSmtMethodNames();
+    TCLAP::ValuesConstraint<std::string> isSmtMethod(smtMethodNames);
+    auto smtBackendNames = GetSmtBackendNames();
+    TCLAP::ValuesConstraint<std::string> isSmtBackend(smtBackendNames);
 
     TCLAP::SwitchArg casSwitch("", "no-spurious", "Deactivates Compare-and-Swap failing spuriously", cmd, false);
     TCLAP::SwitchArg gistSwitch("g", "gist", "Print machine readable gist at the very end", cmd, false);
@@ -50,7 +45,29 @@ inline CommandLineInput Interact(int argc, char** argv) {
     TCLAP::SwitchArg macroNoTabulationSwitch("", "macroNoTabulate", "Turns off tabulation of macro post annotations", cmd, false);
     TCLAP::ValueArg<std::size_t> loopMaxIterArg("", "loopMaxIter", "Maximal iterations for finding a loop invariant before aborting", false, 23, "integer", cmd);
     TCLAP::ValueArg<std::size_t> proofMaxIterArg("", "proofMaxIter", "Maximal iterations for finding an interference set before aborting", false, 7, "integer", cmd);
-
+    TCLAP::ValueArg<std::size_t> proofThreadsArg("", "proofThreads", "Number of API functions verified concurrently (0 uses the hardware concurrency)", false, 0, "integer", cmd);
+    TCLAP::ValueArg<std::size_t> proofTransformerThreadsArg("", "proofTransformerThreads", "Number of disjuncts transformed concurrently, e.g., by posts (0 uses the hardware concurrency)", false, 0, "integer", cmd);
+    TCLAP::ValueArg<std::string> smtMethodArg("", "smtMethod", "Method for discharging batches of implication checks", false, "adaptive", &isSmtMethod, cmd);
+    TCLAP::ValueArg<std::size_t> smtWorkersArg("", "smtWorkers", "Number of threads for parallel SMT solving (0 uses twice the hardware concurrency)", false, 0, "integer", cmd);
+    TCLAP::SwitchArg smtNoModelFilterSwitch("", "smtNoModelFilter", "Turns off eliminating implication checks falsified by models of the premise", cmd, false);
+    TCLAP::ValueArg<std::size_t> smtFilterRoundsArg("", "smtFilterRounds", "Maximal model queries for eliminating implication checks of a batch", false, 8, "integer", cmd);
+    TCLAP::SwitchArg smtNoPortfolioSwitch("", "smtNoPortfolio", "Turns off retrying undecided SMT queries with a portfolio of solver configurations", cmd, false);
+    TCLAP::ValueArg<unsigned int> smtTimeoutArg("", "smtTimeout", "Time budget in milliseconds per SMT query (0 for no budget)", false, 0, "integer", cmd);
+    TCLAP::ValueArg<unsigned int> smtRlimitArg("", "smtRlimit", "Z3 resource budget per SMT query (0 for no budget)", false, 0, "integer", cmd);
+    TCLAP::ValueArg<unsigned int> smtEscalationArg("", "smtEscalation", "Factor by which budgets grow when retrying SMT queries that exceeded them", false, 8, "integer", cmd);
+    TCLAP::SwitchArg smtGroundSwitch("", "smtGround", "Instantiates quantifiers over the data terms of SMT queries instead of relying on MBQI (incomplete)", cmd, false);
+    TCLAP::SwitchArg smtFiniteDomainSwitch("", "smtFiniteDomain", "Encodes data values as bitvectors and flows as arrays, implies --smtGround (experimental, slower than the default encoding)", cmd, false);
+    TCLAP::SwitchArg smtUninterpretedSortsSwitch("", "smtUninterpretedSorts", "Encodes pointers and thread ids as uninterpreted sorts", cmd, false);
+    TCLAP::ValueArg<std::string> smtBackendArg("", "smtBackend", "SMT solver for queries (cvc5 is experimental and requires building with cvc5)", false, "z3", &isSmtBackend, cmd);
+    TCLAP::MultiArg<std::string> smtBackendForArg("", "smtBackendFor", "SMT solver for the queries of a category, e.g., 'stability=cvc5' (cvc5 is experimental)", false, "category=backend", cmd);
+    TCLAP::SwitchArg smtNoPresolveSwitch("", "smtNoPresolve", "Turns off deciding implications among stack axioms natively before invoking Z3", cmd, false);
+    TCLAP::SwitchArg smtPreprocessSwitch("", "smtPreprocess", "Eliminates aliases and simplifies the premise once per batch of implication checks", cmd, false);
+    TCLAP::ValueArg<std::string> smtPreprocessTacticsArg("", "smtPreprocessTactics", "Comma-separated Z3 tactics for simplifying premises, must preserve equivalence", false, "simplify,propagate-values", "tactics", cmd);
+    TCLAP::ValueArg<std::string> smtParamsArg("", "smtParams", "File with Z3 parameters per query category, e.g., as written by 'plankton-tune'", false, "", isFile.get(), cmd);
+    TCLAP::SwitchArg smtNoAsyncSwitch("", "smtNoAsync", "Turns off solving batches of implication checks in the background", cmd, false);
+    TCLAP::ValueArg<std::size_t> smtBatchSizeArg("", "smtBatchSize", "Number of implication checks a solving thread takes at once", false, 16, "integer", cmd);
+
+    TCLAP::ValueArg<std::string> smtRecordArg("", "smtRecord", "File to which SMT queries are appended for replaying with 'plankton-replay'", false, "", "path", cmd);
     TCLAP::ValueArg<std::string> footprintFileArg("f", "footprint", "File to which footprints are exported", false, "", isFile.get(), cmd);
     TCLAP::SwitchArg footprintPrecisionSwitch("p", "precision", "Increases precision when computing flow constraint bounds", cmd, false);
 
@@ -64,6 +81,31 @@ inline CommandLineInput Interact(int argc, char** argv) {
     input.setup->macrosTabulateInvocations = !macroNoTabulationSwitch.getValue();
     input.setup->loopMaxIterations = loopMaxIterArg.getValue();
     input.setup->proofMaxIterations = proofMaxIterArg.getValue();
+    input.setup->proofThreadCount = proofThreadsArg.getValue();
+    input.setup->proofTransformerThreadCount = proofTransformerThreadsArg.getValue();
+    input.setup->smtMethod = SMT_METHODS.at(smtMethodArg.getValue());
+    input.setup->smtWorkerCount = smtWorkersArg.getValue();
+    input.setup->smtBatchSize = smtBatchSizeArg.getValue();
+    input.setup->smtFilterByModel = !smtNoModelFilterSwitch.getValue();
+    input.setup->smtFilterMaxRounds = smtFilterRoundsArg.getValue();
+    input.setup->smtPortfolio = !smtNoPortfolioSwitch.getValue();
+    input.setup->smtTimeout = smtTimeoutArg.getValue();
+    input.setup->smtResourceLimit = smtRlimitArg.getValue();
+    input.setup->smtBudgetEscalation = smtEscalationArg.getValue();
+    input.setup->smtGroundQuantifiers = smtGroundSwitch.getValue();
+    input.setup->smtFiniteDomain = smtFiniteDomainSwitch.getValue();
+    input.setup->smtUninterpretedSorts = smtUninterpretedSortsSwitch.getValue();
+    input.setup->smtBackend = SMT_BACKENDS.at(smtBackendArg.getValue());
+    input.setup->smtBackendByCategory = GetSmtBackendsByCategory(smtBackendForArg.getValue());
+    input.setup->smtPresolve = !smtNoPresolveSwitch.getValue();
+    input.setup->smtPreprocess = smtPreprocessSwitch.getValue();
+    input.setup->smtPreprocessTactics = smtPreprocessTacticsArg.getValue();
+    input.setup->smtAsync = !smtNoAsyncSwitch.getValue();
+    if (smtParamsArg.isSet()) {
+        std::ifstream stream(smtParamsArg.getValue());
+        input.setup->smtParamsByCategory = plankton::ReadSmtParams(stream);
+    }
+    input.setup->smtRecordPath = smtRecordArg.getValue();
     input.setup->footprintPrecision = footprintPrecisionSwitch.getValue();
 
     if (footprintFileArg.isSet()) {
@@ -92,6 +134,7 @@ using milliseconds_t = std::chrono::milliseconds;
 struct VerificationResult {
     bool linearizable = false;
     milliseconds_t timeTaken = milliseconds_t(0);
+    SolvingStatistics solving;
 };
 
 inline VerificationResult Verify(const ParsingResult& input, const CommandLineInput& cmd) {
@@ -104,6 +147,7 @@ inline VerificationResult Verify(const ParsingResult& input, const CommandLineIn
     result.linearizable = plankton::IsLinearizable(*input.program, *input.config, cmd.setup);
     auto end = std::chrono::steady_clock::now();
     result.timeTaken = std::chrono::duration_cast<milliseconds_t>(end - begin);
+    result.solving = plankton::GetSolvingStatistics();
     return result;
 }
 
@@ -125,6 +169,13 @@ inline void PrintResult(const CommandLineInput& cmd, const ParsingResult& input,
     INFO("# Verdict for '" << input.program->name << "':" << std::endl)
     INFO("#   is linearizable: " << (result.linearizable ? "YES" : "NO") << std::endl)
     INFO("#   time taken (ms): " << result.timeTaken.count() << std::endl)
+    if (result.solving.undecided > 0) {
+        INFO("#   undecided SMT queries: " << result.solving.undecided << std::endl)
+        INFO("#     decided by retry: " << result.solving.decidedByRetry << std::endl)
+        INFO("#     decided by portfolio: " << result.solving.decidedByPortfolio << std::endl)
+        INFO("#     assumed not implied: " << result.solving.assumedNotImplied << std::endl)
+        INFO("#     failed: " << result.solving.failed << std::endl)
+    }
     INFO("#" << std::endl << std::endl)
     
     if (!cmd.printGist) return;
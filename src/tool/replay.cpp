@@ -0,0 +1,179 @@
+#include <map>
+#include <chrono>
+#include <fstream>
+#include "tclap/CmdLine.h"
+#include "common.hpp"
+#include "engine/corpus.hpp"
+#include "engine/encoding.hpp"
+#include "engine/setup.hpp"
+#include "engine/params.hpp"
+#include "util/log.hpp"
+
+
+using namespace plankton;
+
+
+//
+// Command Line
+//
+
+struct CommandLineInput {
+    std::string pathToCorpus;
+    std::optional<std::string> category;
+    bool verbose = false;
+    std::shared_ptr<EngineSetup> setup = std::make_shared<EngineSetup>();
+};
+
+inline CommandLineInput Interact(int argc, char** argv) {
+    CommandLineInput input;
+
+    TCLAP::CmdLine cmd("PLANKTON replay tool for recorded SMT queries", ' ', "1.0");
+    auto isFile = std::make_unique<IsRegularFileConstraint>("_to_corpus");
+    auto smtMethodNames = GetSmtMethodNames();
+    TCLAP::ValuesConstraint<std::string> isSmtMethod(smtMethodNames);
+    auto smtBackendNames = GetSmtBackendNames();
+    TCLAP::ValuesConstraint<std::string> isSmtBackend(smtBackendNames);
+
+    TCLAP::UnlabeledValueArg<std::string> corpusArg("corpus", "Corpus file recorded with '--smtRecord'", true, "", isFile.get(), cmd);
+    TCLAP::ValueArg<std::string> categoryArg("c", "category", "Replays only queries of the given category", false, "", "string", cmd);
+    TCLAP::SwitchArg verboseSwitch("v", "verbose", "Prints every replayed query", cmd, false);
+
+    TCLAP::ValueArg<std::string> smtMethodArg("", "smtMethod", "Method for discharging batches of implication checks", false, "adaptive", &isSmtMethod, cmd);
+    TCLAP::ValueArg<std::string> smtBackendArg("", "smtBackend", "SMT solver for queries (cvc5 is experimental and requires building with cvc5)", false, "z3", &isSmtBackend, cmd);
+    TCLAP::MultiArg<std::string> smtBackendForArg("", "smtBackendFor", "SMT solver for the queries of a category, e.g., 'stability=cvc5' (cvc5 is experimental)", false, "category=backend", cmd);
+    TCLAP::ValueArg<std::size_t> smtWorkersArg("", "smtWorkers", "Number of threads for parallel SMT solving (0 uses twice the hardware concurrency)", false, 0, "integer", cmd);
+    TCLAP::SwitchArg smtNoModelFilterSwitch("", "smtNoModelFilter", "Turns off eliminating implication checks falsified by models of the premise", cmd, false);
+    TCLAP::ValueArg<std::size_t> smtFilterRoundsArg("", "smtFilterRounds", "Maximal model queries for eliminating implication checks of a batch", false, 8, "integer", cmd);
+    TCLAP::SwitchArg smtNoPortfolioSwitch("", "smtNoPortfolio", "Turns off retrying undecided SMT queries with a portfolio of solver configurations", cmd, false);
+    TCLAP::ValueArg<unsigned int> smtTimeoutArg("", "smtTimeout", "Time budget in milliseconds per SMT query (0 for no budget)", false, 0, "integer", cmd);
+    TCLAP::ValueArg<unsigned int> smtRlimitArg("", "smtRlimit", "Z3 resource budget per SMT query (0 for no budget)", false, 0, "integer", cmd);
+    TCLAP::ValueArg<unsigned int> smtEscalationArg("", "smtEscalation", "Factor by which budgets grow when retrying SMT queries that exceeded them", false, 8, "integer", cmd);
+    TCLAP::ValueArg<std::string> smtParamsArg("", "smtParams", "File with Z3 parameters per query category, e.g., as written by 'plankton-tune'", false, "", isFile.get(), cmd);
+    TCLAP::ValueArg<std::size_t> smtBatchSizeArg("", "smtBatchSize", "Number of implication checks a solving thread takes at once", false, 16, "integer", cmd);
+
+    cmd.parse(argc, argv);
+    input.pathToCorpus = corpusArg.getValue();
+    if (categoryArg.isSet()) input.category = categoryArg.getValue();
+    input.verbose = verboseSwitch.getValue();
+
+    input.setup->smtMethod = SMT_METHODS.at(smtMethodArg.getValue());
+    input.setup->smtBackend = SMT_BACKENDS.at(smtBackendArg.getValue());
+    input.setup->smtBackendByCategory = GetSmtBackendsByCategory(smtBackendForArg.getValue());
+    input.setup->smtWorkerCount = smtWorkersArg.getValue();
+    input.setup->smtBatchSize = smtBatchSizeArg.getValue();
+    input.setup->smtFilterByModel = !smtNoModelFilterSwitch.getValue();
+    input.setup->smtFilterMaxRounds = smtFilterRoundsArg.getValue();
+    input.setup->smtPortfolio = !smtNoPortfolioSwitch.getValue();
+    input.setup->smtTimeout = smtTimeoutArg.getValue();
+    input.setup->smtResourceLimit = smtRlimitArg.getValue();
+    input.setup->smtBudgetEscalation = smtEscalationArg.getValue();
+    if (smtParamsArg.isSet()) {
+        std::ifstream stream(smtParamsArg.getValue());
+        input.setup->smtParamsByCategory = plankton::ReadSmtParams(stream);
+    }
+
+    return input;
+}
+
+
+//
+// Replay
+//
+
+using microseconds_t = std::chrono::microseconds;
+
+struct CategoryResult {
+    std::size_t queries = 0;
+    std::size_t checks = 0;
+    std::size_t mismatches = 0; // checks with a different result than recorded
+    std::size_t failures = 0; // queries that raised an error
+    microseconds_t recordedTime = microseconds_t(0);
+    microseconds_t replayedTime = microseconds_t(0);
+};
+
+inline std::map<std::string, CategoryResult> Replay(const CommandLineInput& input) {
+    plankton::SetupEncoding(input.setup);
+    std::map<std::string, CategoryResult> result;
+    std::ifstream corpus(input.pathToCorpus);
+    std::size_t counter = 0;
+
+    while (auto entry = plankton::ReadCorpusEntry(corpus)) {
+        if (input.category && entry->category != input.category.value()) continue;
+        auto& category = result[entry->category];
+        category.queries++;
+        category.checks += entry->results.size();
+        category.recordedTime += entry->time;
+
+        auto time = microseconds_t(0);
+        try {
+            auto replay = plankton::ReplayCorpusEntry(*entry);
+            category.mismatches += CountMismatches(entry->results, replay.results);
+            time = replay.time;
+        } catch (std::logic_error& err) {
+            category.failures++;
+            WARNING("replaying query " << counter << " failed: " << err.what() << std::endl)
+        }
+        category.replayedTime += time;
+
+        if (input.verbose) {
+            INFO("[" << counter << "] " << ToString(entry->kind) << " " << entry->category << ": "
+                     << entry->time.count() << "us ~> " << time.count() << "us" << std::endl)
+        }
+        ++counter;
+    }
+    return result;
+}
+
+
+//
+// Reporting
+//
+
+inline void PrintResult(const std::map<std::string, CategoryResult>& result) {
+    CategoryResult total;
+    INFO(std::endl << "#" << std::endl)
+    for (const auto& [name, category] : result) {
+        INFO("# " << name << ": " << category.queries << " queries, " << category.checks << " checks, "
+                  << category.mismatches << " mismatches, " << category.failures << " failures, "
+                  << category.recordedTime.count() / 1000 << "ms recorded, "
+                  << category.replayedTime.count() / 1000 << "ms replayed" << std::endl)
+        total.queries += category.queries;
+        total.checks += category.checks;
+        total.mismatches += category.mismatches;
+        total.failures += category.failures;
+        total.recordedTime += category.recordedTime;
+        total.replayedTime += category.replayedTime;
+    }
+    INFO("#" << std::endl)
+    INFO("# total: " << total.queries << " queries, " << total.checks << " checks, "
+                     << total.mismatches << " mismatches, " << total.failures << " failures, "
+                     << total.recordedTime.count() / 1000 << "ms recorded, "
+                     << total.replayedTime.count() / 1000 << "ms replayed" << std::endl)
+    INFO("#" << std::endl << std::endl)
+}
+
+
+//
+// Main
+//
+
+int main(int argc, char** argv) {
+    try {
+        auto input = Interact(argc, argv);
+        auto result = Replay(input);
+        PrintResult(result);
+        return 0;
+
+    } catch (TCLAP::ArgException& err) {
+        // command line misuse
+        INFO("ERROR: " << err.error() << " for arg " << err.argId() << std::endl << std::endl)
+        ERROR(err.error() << " for arg " << err.argId() << std::endl)
+        return 1;
+
+    } catch (std::logic_error& err) { // TODO: catch proper error class
+        // malformed corpus
+        INFO(std::endl << std::endl << "ERROR: " << err.what() << std::endl << std::endl)
+        ERROR(err.what() << std::endl)
+        return 2;
+    }
+}
@@ -0,0 +1,219 @@
+#include <map>
+#include <chrono>
+#include <fstream>
+#include "tclap/CmdLine.h"
+#include "common.hpp"
+#include "engine/corpus.hpp"
+#include "engine/encoding.hpp"
+#include "engine/setup.hpp"
+#include "engine/params.hpp"
+#include "util/log.hpp"
+
+
+using namespace plankton;
+
+
+//
+// Search Space
+//
+
+struct Dimension {
+    std::string name;
+    std::vector<std::string> values; // the first one is Z3's default
+};
+
+static const std::vector<Dimension> SEARCH_SPACE = {
+        { "auto_config", { "true", "false" } },
+        { "mbqi", { "true", "false" } },
+        { "relevancy", { "2", "0", "1" } },
+        { "case_split", { "1", "0", "3", "5" } },
+        { "phase_selection", { "3", "0", "5", "6" } },
+        { "restart_strategy", { "1", "0", "2" } },
+        { "arith.solver", { "6", "2" } },
+        { "qi.eager_threshold", { "10.0", "5.0", "20.0", "50.0" } },
+        { "qi.lazy_threshold", { "20.0", "50.0", "100.0" } },
+};
+
+
+//
+// Command Line
+//
+
+struct CommandLineInput {
+    std::string pathToCorpus;
+    std::string pathToOutput;
+    std::optional<std::string> category;
+    std::size_t passes = 2;
+    double minGain = 0.05;
+    std::shared_ptr<EngineSetup> setup = std::make_shared<EngineSetup>();
+};
+
+inline CommandLineInput Interact(int argc, char** argv) {
+    CommandLineInput input;
+
+    TCLAP::CmdLine cmd("PLANKTON tuning tool for Z3 parameters over recorded SMT queries", ' ', "1.0");
+    auto isFile = std::make_unique<IsRegularFileConstraint>("_to_corpus");
+    auto smtMethodNames = GetSmtMethodNames();
+    TCLAP::ValuesConstraint<std::string> isSmtMethod(smtMethodNames);
+
+    TCLAP::UnlabeledValueArg<std::string> corpusArg("corpus", "Corpus file recorded with '--smtRecord'", true, "", isFile.get(), cmd);
+    TCLAP::ValueArg<std::string> outputArg("o", "output", "File to which the best parameters are written, for use with '--smtParams'", true, "", "path", cmd);
+    TCLAP::ValueArg<std::string> categoryArg("c", "category", "Tunes only queries of the given category", false, "", "string", cmd);
+    TCLAP::ValueArg<std::size_t> passesArg("", "passes", "Number of passes over all parameters", false, 2, "integer", cmd);
+    TCLAP::ValueArg<double> minGainArg("", "minGain", "Fraction of solving time a parameter change must save to be kept", false, 0.05, "number", cmd);
+
+    TCLAP::ValueArg<std::string> smtMethodArg("", "smtMethod", "Method for discharging batches of implication checks", false, "adaptive", &isSmtMethod, cmd);
+    TCLAP::ValueArg<std::size_t> smtWorkersArg("", "smtWorkers", "Number of threads for parallel SMT solving (0 uses twice the hardware concurrency)", false, 0, "integer", cmd);
+    TCLAP::SwitchArg smtNoPortfolioSwitch("", "smtNoPortfolio", "Turns off retrying undecided SMT queries with a portfolio of solver configurations", cmd, false);
+    TCLAP::ValueArg<unsigned int> smtTimeoutArg("", "smtTimeout", "Time budget in milliseconds per SMT query (0 for no budget)", false, 0, "integer", cmd);
+
+    cmd.parse(argc, argv);
+    input.pathToCorpus = corpusArg.getValue();
+    input.pathToOutput = outputArg.getValue();
+    if (categoryArg.isSet()) input.category = categoryArg.getValue();
+    input.passes = passesArg.getValue();
+    input.minGain = minGainArg.getValue();
+
+    input.setup->smtMethod = SMT_METHODS.at(smtMethodArg.getValue());
+    input.setup->smtWorkerCount = smtWorkersArg.getValue();
+    input.setup->smtPortfolio = !smtNoPortfolioSwitch.getValue();
+    input.setup->smtTimeout = smtTimeoutArg.getValue();
+
+    return input;
+}
+
+
+//
+// Evaluation
+//
+
+using microseconds_t = std::chrono::microseconds;
+
+struct Evaluation {
+    std::size_t mismatches = 0; // checks with a different result than recorded
+    std::size_t failures = 0; // queries that raised an error
+    microseconds_t time = microseconds_t(0);
+    bool aborted = false; // exceeded the time bound, the above are incomplete
+};
+
+struct Tuner {
+    const CommandLineInput& input;
+    const std::string& category;
+    const std::vector<CorpusEntry>& entries;
+
+    explicit Tuner(const CommandLineInput& input, const std::string& category, const std::vector<CorpusEntry>& entries)
+            : input(input), category(category), entries(entries) {}
+
+    [[nodiscard]] Evaluation Evaluate(const SmtParams& params, std::optional<microseconds_t> bound) const {
+        // replaying is synchronous, no query is in flight while the setup changes
+        input.setup->smtParamsByCategory = {{ category, params }};
+        plankton::SetupEncoding(input.setup);
+
+        Evaluation result;
+        for (const auto& entry : entries) {
+            try {
+                auto replay = plankton::ReplayCorpusEntry(entry);
+                result.mismatches += CountMismatches(entry.results, replay.results);
+                result.time += replay.time;
+            } catch (std::logic_error&) {
+                result.failures++;
+            }
+            if (bound && result.time > bound.value()) {
+                result.aborted = true;
+                break;
+            }
+        }
+        return result;
+    }
+
+    SmtParams Tune() const {
+        INFO("# tuning '" << category << "' on " << entries.size() << " queries" << std::endl)
+        SmtParams best;
+        auto baseline = Evaluate(best, std::nullopt);
+        auto bestTime = baseline.time;
+        INFO("#   defaults: " << bestTime.count() / 1000 << "ms, " << baseline.mismatches << " mismatches, "
+                             << baseline.failures << " failures" << std::endl)
+
+        for (std::size_t pass = 0; pass < input.passes; ++pass) {
+            bool improved = false;
+            for (const auto& dimension : SEARCH_SPACE) {
+                for (const auto& value : dimension.values) {
+                    auto candidate = best;
+                    if (value == dimension.values.front()) candidate.erase(dimension.name);
+                    else candidate[dimension.name] = value;
+                    if (candidate == best) continue;
+
+                    auto required = microseconds_t((long long) (bestTime.count() * (1.0 - input.minGain)));
+                    auto evaluation = Evaluate(candidate, required);
+                    if (evaluation.aborted || evaluation.failures > 0) continue;
+                    if (evaluation.mismatches > baseline.mismatches || evaluation.time >= required) continue;
+
+                    INFO("#   " << dimension.name << "=" << value << ": " << evaluation.time.count() / 1000 << "ms"
+                                << std::endl)
+                    best = std::move(candidate);
+                    bestTime = evaluation.time;
+                    improved = true;
+                }
+            }
+            if (!improved) break;
+        }
+
+        INFO("#   best: " << bestTime.count() / 1000 << "ms with " << best.size() << " non-default parameters"
+                         << std::endl << "#" << std::endl)
+        return best;
+    }
+};
+
+
+//
+// Tuning
+//
+
+inline std::map<std::string, std::vector<CorpusEntry>> ReadCorpus(const CommandLineInput& input) {
+    std::map<std::string, std::vector<CorpusEntry>> result;
+    std::ifstream corpus(input.pathToCorpus);
+    while (auto entry = plankton::ReadCorpusEntry(corpus)) {
+        if (input.category && entry->category != input.category.value()) continue;
+        result[entry->category].push_back(std::move(entry.value()));
+    }
+    return result;
+}
+
+inline SmtParamsByCategory Tune(const CommandLineInput& input) {
+    SmtParamsByCategory result;
+    INFO(std::endl << "#" << std::endl)
+    for (const auto& [category, entries] : ReadCorpus(input)) {
+        auto params = Tuner(input, category, entries).Tune();
+        if (!params.empty()) result[category] = std::move(params);
+    }
+    return result;
+}
+
+
+//
+// Main
+//
+
+int main(int argc, char** argv) {
+    try {
+        auto input = Interact(argc, argv);
+        auto result = Tune(input);
+        std::ofstream output(input.pathToOutput);
+        output << "# Z3 parameters per query category, written by 'plankton-tune'" << std::endl;
+        plankton::WriteSmtParams(output, result);
+        INFO("# parameters written to '" << input.pathToOutput << "'" << std::endl << std::endl)
+        return 0;
+
+    } catch (TCLAP::ArgException& err) {
+        // command line misuse
+        INFO("ERROR: " << err.error() << " for arg " << err.argId() << std::endl << std::endl)
+        ERROR(err.error() << " for arg " << err.argId() << std::endl)
+        return 1;
+
+    } catch (std::logic_error& err) { // TODO: catch proper error class
+        // malformed corpus
+        INFO(std::endl << std::endl << "ERROR: " << err.what() << std::endl << std::endl)
+        ERROR(err.what() << std::endl)
+        return 2;
+    }
+}